@@ -1,5 +1,19 @@
 #include <LiquidCrystal.h>
 
+// Тестер джойстика: измеряет дребезг и длительность нажатий по всем пяти
+// кнопкам, чтобы подобрать DEBOUNCE_DELAY и JOYSTICK_DELAY в main/config.h
+// по реальным данным, а не на глаз.
+//
+// Каждый фронт (нажатие или отпускание) начинается с первого изменения уровня
+// и заканчивается, когда уровень QUIET_US не меняется. Длительность дребезга —
+// время от первого до последнего переключения, число отскоков — сколько раз
+// уровень переключился сверх одного раза.
+//
+// Serial, 115200:
+//   каждый фронт — одной строкой
+//   r — гистограммы по всем кнопкам
+//   c — сбросить статистику
+
 // --- ПИНЫ ---
 // Подключение LCD-экрана
 constexpr uint8_t PIN_RS = 6;
@@ -17,39 +31,323 @@ const int JOY_DOWN = 4;
 const int JOY_LEFT = 5;
 const int JOY_RIGHT = 12;
 
+const unsigned long SERIAL_BAUD = 115200;
+
+// --- ПАРАМЕТРЫ ИЗМЕРЕНИЯ ---
+const unsigned long QUIET_US = 20000;           // столько без переключений — фронт закончен
+const unsigned long DISPLAY_REFRESH_US = 100000; // не чаще 10 раз в секунду
+
+// Гистограммы с удваивающимися корзинами: первая — "меньше FIRST",
+// каждая следующая вдвое шире, последняя — всё, что больше
+const uint8_t BOUNCE_TIME_BINS = 10;            // <64us ... >=16ms
+const unsigned long BOUNCE_TIME_FIRST = 64;
+const uint8_t FLIP_BINS = 6;                    // 0, 1, 2-3, 4-7, 8-15, 16+
+const unsigned long FLIP_FIRST = 1;
+const uint8_t PRESS_BINS = 8;                   // <32ms ... >=2048ms
+const unsigned long PRESS_FIRST = 32;
+
+// Статистика одной кнопки
+struct PinStats {
+  uint16_t edges;        // завершённые фронты
+  uint16_t glitches;     // импульсы, после которых уровень вернулся обратно
+  uint16_t presses;
+  unsigned long maxBounceUs;
+  unsigned long sumBounceUs;
+  uint16_t maxFlips;
+  uint16_t bounceTimeHist[BOUNCE_TIME_BINS];
+  uint16_t flipHist[FLIP_BINS];
+  uint16_t pressHist[PRESS_BINS];
+};
+
+// Состояние одной кнопки
+struct PinProbe {
+  uint8_t pin;
+  char letter;
+  volatile uint8_t* port; // регистр PINx — читается за один такт, в отличие от digitalRead()
+  uint8_t mask;
+  bool raw;               // последнее прочитанное значение
+  bool stable;            // уровень после завершения последнего фронта
+  bool settling;          // фронт ещё не закончился
+  unsigned long edgeStart;
+  unsigned long lastFlip;
+  uint16_t flips;
+  unsigned long pressStart;
+  PinStats stats;
+};
+
+const uint8_t PIN_COUNT = 5;
+PinProbe probes[PIN_COUNT] = {
+  {JOY_CENTER, 'C'}, {JOY_UP, 'U'}, {JOY_DOWN, 'D'}, {JOY_LEFT, 'L'}, {JOY_RIGHT, 'R'}
+};
+
+// Сам тестер: насколько часто реально опрашиваются кнопки
+unsigned long lastSampleUs = 0;
+unsigned long maxSampleGapUs = 0;
+unsigned long sampleCount = 0;
+unsigned long statsStartMs = 0;
+
+// Последний завершённый фронт (для экрана)
+int8_t lastEdgePin = -1;
+bool lastEdgePress = false;
+unsigned long lastEdgeBounceUs = 0;
+
+// --- ЭКРАН ---
+// Текст собирается в screenText, а на LCD уходит по одному изменённому символу
+// за проход loop(), и только пока ни одна кнопка не дребезжит: вывод на
+// LiquidCrystal занимает сотни микросекунд и иначе пропускал бы переключения.
+char screenText[2][17];
+char screenShown[2][16];
+uint8_t screenScan = 0;    // следующая проверяемая позиция, 0..31
+int8_t lcdCursor = -1;     // куда LCD напишет следующий символ, -1 — неизвестно
+bool screenDirty = true;
+unsigned long lastScreenBuild = 0;
+
+uint8_t log2Bin(unsigned long value, unsigned long first, uint8_t bins) {
+  uint8_t bin = 0;
+  unsigned long limit = first;
+  while (bin < bins - 1 && value >= limit) {
+    limit <<= 1;
+    bin++;
+  }
+  return bin;
+}
+
+void clearStats() {
+  for (uint8_t i = 0; i < PIN_COUNT; i++) {
+    memset(&probes[i].stats, 0, sizeof(PinStats));
+  }
+  maxSampleGapUs = 0;
+  sampleCount = 0;
+  statsStartMs = millis();
+  lastSampleUs = micros();
+  lastEdgePin = -1;
+  screenDirty = true;
+}
+
+// Фронт закончился: уровень не менялся QUIET_US
+void finishEdge(uint8_t index) {
+  PinProbe& p = probes[index];
+  PinStats& s = p.stats;
+  unsigned long bounceUs = p.lastFlip - p.edgeStart;
+  uint16_t bounces = p.flips - 1;
+  p.settling = false;
+
+  s.edges++;
+  s.sumBounceUs += bounceUs;
+  if (bounceUs > s.maxBounceUs) s.maxBounceUs = bounceUs;
+  if (bounces > s.maxFlips) s.maxFlips = bounces;
+  s.bounceTimeHist[log2Bin(bounceUs, BOUNCE_TIME_FIRST, BOUNCE_TIME_BINS)]++;
+  s.flipHist[log2Bin(bounces, FLIP_FIRST, FLIP_BINS)]++;
+
+  Serial.print(p.letter);
+  if (p.raw == p.stable) {
+    // Чётное число переключений: помеха, а не нажатие
+    s.glitches++;
+    Serial.print(F(" glitch"));
+  } else if (p.raw) {
+    p.pressStart = p.edgeStart;
+    Serial.print(F(" press"));
+  } else {
+    unsigned long pressMs = (p.edgeStart - p.pressStart) / 1000;
+    s.presses++;
+    s.pressHist[log2Bin(pressMs, PRESS_FIRST, PRESS_BINS)]++;
+    Serial.print(F(" release len="));
+    Serial.print(pressMs);
+    Serial.print(F("ms"));
+  }
+  Serial.print(F(" bounce="));
+  Serial.print(bounceUs);
+  Serial.print(F("us flips="));
+  Serial.println(bounces);
+
+  if (p.raw != p.stable) {
+    lastEdgePin = index;
+    lastEdgePress = p.raw;
+    lastEdgeBounceUs = bounceUs;
+  }
+  p.stable = p.raw;
+  screenDirty = true;
+}
+
+// Один опрос всех кнопок. Возвращает true, пока хоть одна дребезжит.
+bool samplePins() {
+  unsigned long now = micros();
+  unsigned long gap = now - lastSampleUs;
+  if (gap > maxSampleGapUs) maxSampleGapUs = gap;
+  lastSampleUs = now;
+  sampleCount++;
+
+  bool busy = false;
+  for (uint8_t i = 0; i < PIN_COUNT; i++) {
+    PinProbe& p = probes[i];
+    // Кнопки подключены к 5V через внешний pull-down: HIGH — нажата
+    bool level = (*p.port & p.mask) != 0;
+    if (level != p.raw) {
+      p.raw = level;
+      if (!p.settling) {
+        p.settling = true;
+        p.edgeStart = now;
+        p.flips = 0;
+      }
+      if (p.flips < 0xFFFF) p.flips++;
+      p.lastFlip = now;
+    } else if (p.settling && now - p.lastFlip >= QUIET_US) {
+      finishEdge(i);
+    }
+    busy |= p.settling;
+  }
+  return busy;
+}
+
+// Строка 0: состояние кнопок и последний фронт, например "cUdlr  U+  1.2ms"
+// Строка 1: по той же кнопке — фронты, худший дребезг (мс), больше всего отскоков
+void buildScreen() {
+  char live[PIN_COUNT + 1];
+  for (uint8_t i = 0; i < PIN_COUNT; i++) {
+    live[i] = probes[i].stable ? probes[i].letter : probes[i].letter + ('a' - 'A');
+  }
+  live[PIN_COUNT] = '\0';
+
+  if (lastEdgePin < 0) {
+    snprintf(screenText[0], sizeof(screenText[0]), "%s press key", live);
+    snprintf(screenText[1], sizeof(screenText[1]), "r=report c=clear");
+    return;
+  }
+
+  const PinProbe& p = probes[lastEdgePin];
+  unsigned long tenths = min(lastEdgeBounceUs / 100, 999UL);
+  snprintf(screenText[0], sizeof(screenText[0]), "%s  %c%c%3lu.%lums", live, p.letter,
+           lastEdgePress ? '+' : '-', tenths / 10, tenths % 10);
+  unsigned long worstTenths = min(p.stats.maxBounceUs / 100, 999UL);
+  snprintf(screenText[1], sizeof(screenText[1]), "n%-3u mx%2lu.%lu b%-2u",
+           min(p.stats.edges, (uint16_t)999), worstTenths / 10, worstTenths % 10,
+           min(p.stats.maxFlips, (uint16_t)99));
+}
+
+// Выводит на LCD не больше одного изменившегося символа
+void pushScreenChar() {
+  for (uint8_t n = 0; n < 32; n++) {
+    uint8_t pos = screenScan;
+    screenScan = (screenScan + 1) % 32;
+    uint8_t row = pos / 16;
+    uint8_t col = pos % 16;
+    char c = screenText[row][col];
+    if (c == '\0') c = ' ';
+    if (screenShown[row][col] == c) continue;
+
+    if (lcdCursor != pos) {
+      lcd.setCursor(col, row);
+    }
+    lcd.write(c);
+    screenShown[row][col] = c;
+    lcdCursor = (col == 15) ? -1 : pos + 1; // после конца строки адрес DDRAM не переходит на следующую
+    return;
+  }
+}
+
+void printHistogram(const __FlashStringHelper* label, const uint16_t* hist, uint8_t bins,
+                    unsigned long first, const __FlashStringHelper* unit) {
+  Serial.print(F("  "));
+  Serial.print(label);
+  unsigned long limit = first;
+  for (uint8_t b = 0; b < bins; b++) {
+    Serial.print(b < bins - 1 ? F(" <") : F(" >="));
+    Serial.print(b < bins - 1 ? limit : limit >> 1);
+    Serial.print(unit);
+    Serial.print(':');
+    Serial.print(hist[b]);
+    limit <<= 1;
+  }
+  Serial.println();
+}
+
+// Полный отчёт. Serial.print здесь блокирует, опрос на это время стоит.
+void printReport() {
+  unsigned long elapsedMs = millis() - statsStartMs;
+  unsigned long worstBounceUs = 0;
+
+  Serial.println(F("--- report ---"));
+  Serial.print(F("samples/s="));
+  Serial.print(elapsedMs ? (unsigned long)(sampleCount * 1000.0 / elapsedMs) : 0UL);
+  Serial.print(F(" max_gap="));
+  Serial.print(maxSampleGapUs);
+  Serial.println(F("us"));
+
+  for (uint8_t i = 0; i < PIN_COUNT; i++) {
+    const PinStats& s = probes[i].stats;
+    if (s.maxBounceUs > worstBounceUs) worstBounceUs = s.maxBounceUs;
+    Serial.print(probes[i].letter);
+    Serial.print(F(" edges="));
+    Serial.print(s.edges);
+    Serial.print(F(" glitches="));
+    Serial.print(s.glitches);
+    Serial.print(F(" presses="));
+    Serial.print(s.presses);
+    Serial.print(F(" bounce max="));
+    Serial.print(s.maxBounceUs);
+    Serial.print(F("us mean="));
+    Serial.print(s.edges ? s.sumBounceUs / s.edges : 0);
+    Serial.print(F("us flips max="));
+    Serial.println(s.maxFlips);
+    printHistogram(F("bounce"), s.bounceTimeHist, BOUNCE_TIME_BINS, BOUNCE_TIME_FIRST, F("us"));
+    printHistogram(F("flips "), s.flipHist, FLIP_BINS, FLIP_FIRST, F(""));
+    printHistogram(F("press "), s.pressHist, PRESS_BINS, PRESS_FIRST, F("ms"));
+  }
+  // Дребезг длиннее этого значения не встречался: отсюда нижняя граница для подавления дребезга
+  Serial.print(F("worst bounce="));
+  Serial.print(worstBounceUs);
+  Serial.println(F("us"));
+
+  // Время отчёта не считается пропуском опроса
+  lastSampleUs = micros();
+}
+
+void pollSerial() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    if (c == 'r') {
+      printReport();
+    } else if (c == 'c') {
+      clearStats();
+      Serial.println(F("cleared"));
+    }
+  }
+}
+
 void setup() {
   // Инициализация LCD
   lcd.begin(16, 2);
-  
-  // Настройка пинов джойстика для работы с внешним pull-down резистором
-  pinMode(JOY_CENTER, INPUT);
-  pinMode(JOY_UP, INPUT);
-  pinMode(JOY_DOWN, INPUT);
-  pinMode(JOY_LEFT, INPUT);
-  pinMode(JOY_RIGHT, INPUT);
-  
-  lcd.print("Press a button");
+  lcd.clear();
+  memset(screenShown, ' ', sizeof(screenShown));
+
+  Serial.begin(SERIAL_BAUD);
+
+  for (uint8_t i = 0; i < PIN_COUNT; i++) {
+    PinProbe& p = probes[i];
+    // Настройка пинов джойстика для работы с внешним pull-down резистором
+    pinMode(p.pin, INPUT);
+    p.port = portInputRegister(digitalPinToPort(p.pin));
+    p.mask = digitalPinToBitMask(p.pin);
+    p.raw = (*p.port & p.mask) != 0;
+    p.stable = p.raw;
+  }
+
+  clearStats();
+  Serial.println(F("Button tester: r=report c=clear"));
 }
 
 void loop() {
-  lcd.setCursor(0, 1);
-  lcd.print("                "); // Очищаем вторую строку
-  lcd.setCursor(0, 1);
-
-  // Теперь проверяем на HIGH, так как кнопки подключены к 5V
-  if (digitalRead(JOY_UP) == HIGH) {
-    lcd.print("UP");
-  } else if (digitalRead(JOY_DOWN) == HIGH) {
-    lcd.print("DOWN");
-  } else if (digitalRead(JOY_LEFT) == HIGH) {
-    lcd.print("LEFT");
-  } else if (digitalRead(JOY_RIGHT) == HIGH) {
-    lcd.print("RIGHT");
-  } else if (digitalRead(JOY_CENTER) == HIGH) {
-    lcd.print("CENTER");
-  } else {
-    // Ничего не нажато
+  if (samplePins()) {
+    return; // идёт фронт: только опрос, без вывода
   }
-  
-  delay(100); // Небольшая задержка для стабильности
-} 
+
+  pollSerial();
+
+  unsigned long now = micros();
+  if (screenDirty && now - lastScreenBuild >= DISPLAY_REFRESH_US) {
+    buildScreen();
+    screenDirty = false;
+    lastScreenBuild = now;
+  }
+  pushScreenChar();
+}
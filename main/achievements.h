@@ -0,0 +1,73 @@
+#ifndef ACHIEVEMENTS_H
+#define ACHIEVEMENTS_H
+
+#include "config.h"
+#include "game_state.h"
+
+// --- ACHIEVEMENTS ---
+// Each counter has a cursor at its next locked threshold. The mutator that
+// changes a counter calls checkAchievement(), which compares against that one
+// threshold, so the cost per mutation does not grow with the table. Cursors
+// only move forward: cookies that are spent again don't re-lock anything.
+
+uint8_t achievementCursor[ACH_COUNTER_COUNT]; // next ACHIEVEMENTS index per counter
+int8_t pendingAchievement = -1;               // unlocked, not yet announced
+
+inline bool isAchievementUnlocked(uint8_t id) {
+  return game.achievements[id / 8] & (1 << (id % 8));
+}
+
+uint8_t countAchievements() {
+  uint8_t count = 0;
+  for (uint8_t id = 0; id < ACHIEVEMENT_COUNT; id++) {
+    if (isAchievementUnlocked(id)) count++;
+  }
+  return count;
+}
+
+inline long achievementThreshold(uint8_t id) {
+  return pgm_read_dword(&ACHIEVEMENTS[id].threshold);
+}
+
+// Copies the name into buf (at least sizeof(AchievementDef::name) bytes)
+void readAchievementName(uint8_t id, char* buf) {
+  strcpy_P(buf, ACHIEVEMENTS[id].name);
+}
+
+void unlockAchievement(uint8_t id, bool announce) {
+  if (isAchievementUnlocked(id)) return;
+  game.achievements[id / 8] |= 1 << (id % 8);
+  markDirty(DIRTY_ACHIEVEMENTS);
+  if (announce) {
+    pendingAchievement = id;
+  }
+}
+
+void checkAchievement(AchievementCounter counter, long value) {
+  uint8_t& next = achievementCursor[counter];
+  uint8_t end = pgm_read_byte(&ACHIEVEMENT_GROUP_START[counter + 1]);
+  // Normally one compare; a jump past several thresholds unlocks each of them
+  while (next < end && value >= achievementThreshold(next)) {
+    unlockAchievement(next, true);
+    next++;
+  }
+}
+
+// After a load: put every cursor past the unlocked bits and silently unlock
+// whatever the loaded counters have already reached
+void syncAchievements() {
+  const long values[ACH_COUNTER_COUNT] = {
+    game.cookies, game.totalClicks, game.totalUpgrades, game.autoClickLevel, game.prestigeClickLevel
+  };
+  for (uint8_t counter = 0; counter < ACH_COUNTER_COUNT; counter++) {
+    uint8_t next = pgm_read_byte(&ACHIEVEMENT_GROUP_START[counter]);
+    uint8_t end = pgm_read_byte(&ACHIEVEMENT_GROUP_START[counter + 1]);
+    while (next < end && (isAchievementUnlocked(next) || values[counter] >= achievementThreshold(next))) {
+      unlockAchievement(next, false);
+      next++;
+    }
+    achievementCursor[counter] = next;
+  }
+}
+
+#endif // ACHIEVEMENTS_H
@@ -0,0 +1,59 @@
+#ifndef AUTO_REPEAT_H
+#define AUTO_REPEAT_H
+
+#include "config.h"
+
+// --- AUTO-REPEAT ---
+// Turns a held input into a stream of events along a RepeatCurve. Due times are
+// kept as timestamps, so a slow frame returns every repeat it covered instead of
+// dropping them; a very long gap is paid out REPEAT_MAX_BATCH events per call.
+// A release shorter than REPEAT_RELEASE_MS is contact bounce and does not end
+// the hold (Button_Tester measures how long our joysticks actually bounce).
+
+const uint8_t REPEAT_MAX_BATCH = 16;
+const unsigned long REPEAT_RELEASE_MS = 30;
+
+class AutoRepeat {
+public:
+  explicit AutoRepeat(const RepeatCurve& curve) : curve_(curve) {}
+
+  // Number of events due at `now` for an input that is (or is not) held
+  uint8_t update(bool held, unsigned long now) {
+    if (!held) {
+      if (held_ && now - lastHeld_ >= REPEAT_RELEASE_MS) {
+        held_ = false;
+      }
+      return 0;
+    }
+    lastHeld_ = now;
+    if (!held_) {
+      held_ = true;
+      interval_ = curve_.interval;
+      nextDue_ = now + curve_.delay;
+      return 1;
+    }
+    uint8_t events = 0;
+    // Signed difference: correct across the millis() wraparound
+    while ((long)(now - nextDue_) >= 0 && events < REPEAT_MAX_BATCH) {
+      events++;
+      nextDue_ += interval_;
+      unsigned int next = (unsigned long)interval_ * curve_.accelPercent / 100;
+      interval_ = next > curve_.minInterval ? next : curve_.minInterval;
+    }
+    return events;
+  }
+
+  // Forget the current hold; the next held update() starts over
+  void release() {
+    held_ = false;
+  }
+
+private:
+  const RepeatCurve& curve_;
+  bool held_ = false;
+  unsigned long nextDue_ = 0;
+  unsigned long lastHeld_ = 0;
+  unsigned int interval_ = 0;
+};
+
+#endif // AUTO_REPEAT_H
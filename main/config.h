@@ -2,10 +2,72 @@
 #define CONFIG_H
 
 #include <Arduino.h>
-#include <LiquidCrystal.h>
 #include <EEPROM.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+
+// LCD bus-traffic budget suite (lcd_budget.h). Set to 1 to replace the game
+// with the scripted scenarios and a per-scenario report on Serial.
+#ifndef LCD_BUDGET_CHECK
+#define LCD_BUDGET_CHECK 0
+#endif
+
+// Line-oriented command console on Serial (serial_console.h). It can set
+// cookies and levels, so it is for test and soak builds only: -DSERIAL_CONSOLE=1.
+#ifndef SERIAL_CONSOLE
+#define SERIAL_CONSOLE 0
+#endif
+
+// Read-only history reader (history_log.h): a "history" line on Serial gets the
+// session history log back, in builds without the console too. It accepts
+// nothing else, so it is safe to leave on in production.
+#ifndef HISTORY_SERIAL
+#define HISTORY_SERIAL 1
+#endif
+
+// Hardware watchdog (watchdog.h). Resets the board when one pass of loop() runs
+// past WATCHDOG_TIMEOUT (a WDTO_* value from <avr/wdt.h>); the next boot
+// reports which stage it was stuck in. Saves take ~150 ms, so keep it above that.
+#ifndef WATCHDOG
+#define WATCHDOG 1
+#endif
+#ifndef WATCHDOG_TIMEOUT
+#define WATCHDOG_TIMEOUT WDTO_1S
+#endif
+
+// Joystick moves jump between the buttons of the current screen (focus_ring.h)
+// instead of stepping one cell at a time. Set to 0 for cell-by-cell movement.
+#ifndef FOCUS_NAVIGATION
+#define FOCUS_NAVIGATION 1
+#endif
+
+// Accelerated virtual-time simulator (virtual_time.h). Set to 1 to run the
+// game on a simulated clock that jumps straight to the next pending deadline.
+#ifndef VIRTUAL_TIME
+#define VIRTUAL_TIME 0
+#endif
+
+// Test builds that run on a real unit but must leave its save alone: the budget
+// suite and the simulator keep saves and the history log in RAM (save_system.h,
+// history_log.h). The save is still loaded at boot.
+#define RAM_STORAGE (LCD_BUDGET_CHECK || VIRTUAL_TIME)
+
+// Game time. Everything timed in the game reads this instead of millis().
+#if VIRTUAL_TIME
+// One virtual hour before millis() wraps, so every run crosses the wraparound
+const unsigned long VIRTUAL_TIME_START = 0xFFFFFFFFUL - 3600000UL;
+const unsigned long VIRTUAL_TIME_REPORT_INTERVAL = 3600000UL; // Serial line per virtual hour
+const unsigned long VIRTUAL_TIME_FRAME_MS = 100; // real ms between renders
+extern unsigned long virtualMillis;
+inline unsigned long nowMs() {
+  return virtualMillis;
+}
+#else
+inline unsigned long nowMs() {
+  return millis();
+}
+#endif
 
 // LCD Screen Connection
 constexpr uint8_t PIN_RS = 6;
@@ -15,6 +77,76 @@ constexpr uint8_t PIN_DB5 = 9;
 constexpr uint8_t PIN_DB6 = 10;
 constexpr uint8_t PIN_DB7 = 11;
 
+// --- Display Geometry ---
+// The panel is chosen at build time: -DLCD_PANEL_20X4 or -DLCD_PANEL_40X2, 16x2 otherwise.
+#if defined(LCD_PANEL_20X4)
+constexpr int LCD_WIDTH = 20;
+constexpr int LCD_HEIGHT = 4;
+#elif defined(LCD_PANEL_40X2)
+constexpr int LCD_WIDTH = 40;
+constexpr int LCD_HEIGHT = 2;
+#else
+constexpr int LCD_WIDTH = 16;
+constexpr int LCD_HEIGHT = 2;
+#endif
+
+// Size and bounds shared by every panel
+template <uint8_t W, uint8_t H>
+struct PanelGeometry {
+  static constexpr uint8_t WIDTH = W;
+  static constexpr uint8_t HEIGHT = H;
+  static constexpr uint8_t LAST_X = W - 1;
+  static constexpr uint8_t LAST_Y = H - 1;
+
+  static constexpr bool inBounds(int x, int y) {
+    return x >= 0 && x < W && y >= 0 && y < H;
+  }
+};
+
+// Per-panel layout of the MAIN screen: gift slots on the top row between the
+// cookie counter and the farm, menu buttons on MENU_ROW. Only the sizes
+// specialised below exist, so an unsupported panel fails to compile.
+template <uint8_t W, uint8_t H>
+struct PanelLayout;
+
+template <>
+struct PanelLayout<16, 2> : PanelGeometry<16, 2> {
+  static constexpr uint8_t GIFT_X_START = 8;
+  static constexpr uint8_t GIFT_SLOTS = 4;
+  static constexpr uint8_t FARM_X_START = 12;
+  static constexpr uint8_t MENU_ROW = 1; // SHOP / a / *
+};
+
+template <>
+struct PanelLayout<20, 4> : PanelGeometry<20, 4> {
+  static constexpr uint8_t GIFT_X_START = 10;
+  static constexpr uint8_t GIFT_SLOTS = 6;
+  static constexpr uint8_t FARM_X_START = 16;
+  static constexpr uint8_t MENU_ROW = 3;
+};
+
+template <>
+struct PanelLayout<40, 2> : PanelGeometry<40, 2> {
+  static constexpr uint8_t GIFT_X_START = 10;
+  static constexpr uint8_t GIFT_SLOTS = 20;
+  static constexpr uint8_t FARM_X_START = 32;
+  static constexpr uint8_t MENU_ROW = 1;
+};
+
+typedef PanelLayout<LCD_WIDTH, LCD_HEIGHT> Panel;
+static_assert(Panel::GIFT_X_START + Panel::GIFT_SLOTS <= Panel::FARM_X_START, "gift slots overlap the farm");
+
+// Farm ("J") cells: every row from FARM_X_START to the right edge
+constexpr bool isFarmCell(int x, int y) {
+  return x >= Panel::FARM_X_START && Panel::inBounds(x, y);
+}
+
+// Serial port (diagnostics)
+const unsigned long SERIAL_BAUD = 115200;
+// Dumps print a line only once the TX buffer has room for this much, so they
+// never wait on the port: the longest dump line with its CRLF (HardwareSerial buffers 63)
+const uint8_t SERIAL_DUMP_LINE_MAX = 62;
+
 // Custom Characters
 // Cookie Icon
 extern uint8_t cookieIcon[8];
@@ -25,9 +157,101 @@ extern uint8_t filledBlock[8];
 // Star Icon
 extern uint8_t starIcon[8];
 
-// Game Variables
-extern long cookies;
-extern int cookiesPerClick;
+// --- Generators ---
+// Buildings that produce cookies every AUTOCLICK_INTERVAL, next to the
+// autoclicker. The table lives in flash (variables.cpp); read entries with
+// readGenerator(). Adding a row to the table is all a new building needs.
+struct GeneratorDef {
+  char name[8];
+  long baseCost;         // price of the first one
+  uint8_t growthPercent; // each one bought makes the next this much dearer, 115 = x1.15
+  long yield;            // cookies per AUTOCLICK_INTERVAL, per building
+};
+const uint8_t GENERATOR_COUNT = 5;
+const uint8_t GENERATOR_MAX_LEVEL = 99;
+extern const GeneratorDef GENERATORS[GENERATOR_COUNT] PROGMEM;
+extern uint8_t generatorShopIndex; // building shown in the generator shop
+
+inline GeneratorDef readGenerator(uint8_t type) {
+  GeneratorDef def;
+  memcpy_P(&def, &GENERATORS[type], sizeof(def));
+  return def;
+}
+
+// --- Achievements ---
+// Thresholds on five counters, in one flash table grouped by counter and sorted
+// by threshold within each group (variables.cpp). achievements.h walks each
+// group with a cursor; unlocked ones are a bitset in the save.
+enum AchievementCounter {
+  ACH_COOKIES,
+  ACH_CLICKS,
+  ACH_UPGRADES,
+  ACH_AUTOCLICK,
+  ACH_PRESTIGE,
+  ACH_COUNTER_COUNT
+};
+struct AchievementDef {
+  long threshold;
+  char name[14];
+};
+const uint8_t ACHIEVEMENT_COUNT = 16;
+const uint8_t ACHIEVEMENT_BYTES = (ACHIEVEMENT_COUNT + 7) / 8;
+extern const AchievementDef ACHIEVEMENTS[ACHIEVEMENT_COUNT] PROGMEM;
+extern const uint8_t ACHIEVEMENT_GROUP_START[ACH_COUNTER_COUNT + 1] PROGMEM; // group i is [start[i], start[i + 1])
+
+// --- Game State ---
+// Everything the game shows or saves lives in one struct. Write it only through
+// the mutators in game_state.h: they set the dirty bits below, which drive both
+// rendering (dirty) and saving (unsaved).
+const uint16_t DIRTY_COOKIES = 1 << 0;
+const uint16_t DIRTY_CLICK_POWER = 1 << 1;
+const uint16_t DIRTY_TOTAL_COOKIES = 1 << 2;
+const uint16_t DIRTY_TOTAL_CLICKS = 1 << 3;
+const uint16_t DIRTY_TOTAL_UPGRADES = 1 << 4;
+const uint16_t DIRTY_AUTOCLICK = 1 << 5;
+const uint16_t DIRTY_PRESTIGE = 1 << 6;
+const uint16_t DIRTY_GIFT = 1 << 7;
+const uint16_t DIRTY_BONUS = 1 << 8;
+const uint16_t DIRTY_CONGRATS = 1 << 9;
+const uint16_t DIRTY_CURSOR = 1 << 10;
+const uint16_t DIRTY_SCREEN = 1 << 11; // whole screen must be redrawn
+const uint16_t DIRTY_RATES = 1 << 12;  // a second closed in rate_stats.h
+const uint16_t DIRTY_GENERATORS = 1 << 13;
+const uint16_t DIRTY_ACHIEVEMENTS = 1 << 14;
+// Fields that are part of GameData
+const uint16_t DIRTY_PERSISTENT = DIRTY_COOKIES | DIRTY_CLICK_POWER | DIRTY_TOTAL_COOKIES |
+                                  DIRTY_TOTAL_CLICKS | DIRTY_TOTAL_UPGRADES | DIRTY_AUTOCLICK |
+                                  DIRTY_PRESTIGE | DIRTY_GENERATORS | DIRTY_ACHIEVEMENTS;
+// Persistent fields that creep up all the time (clicks, passive income). They are
+// saved at most once per AUTOSAVE_INTERVAL; any other persistent change is a
+// purchase, gift or prestige and is saved right away.
+const uint16_t DIRTY_DRIFT = DIRTY_COOKIES | DIRTY_TOTAL_COOKIES | DIRTY_TOTAL_CLICKS;
+
+struct GameModel {
+  // Persistent
+  long cookies;
+  int cookiesPerClick;
+  long totalCookies;
+  long totalClicks;
+  long totalUpgrades;
+  int autoClickLevel; // Level 0 means not purchased
+  int prestigeClickLevel;
+  int prestigeAutoClickLevel;
+  uint8_t generatorLevels[GENERATOR_COUNT];
+  uint8_t achievements[ACHIEVEMENT_BYTES]; // unlocked bits, by ACHIEVEMENTS index
+  // Derived, kept up to date by the mutators
+  long passiveIncome; // autoclicker + generators, cookies per AUTOCLICK_INTERVAL
+  // Session
+  bool giftActive;
+  int giftType;
+  int giftPos;
+  bool bonus573Active;
+  bool congratsActive;
+  // Change tracking
+  uint16_t dirty;   // not yet rendered
+  uint16_t unsaved; // not yet written to EEPROM
+};
+extern GameModel game;
 
 // Cursor Variables
 extern int cursorX;
@@ -42,33 +266,68 @@ enum GameState {
   STATS,
   AUTOCLICK_SHOP,
   PRESTIGE_CONFIRM,
-  MESSAGE_SCREEN
+  MESSAGE_SCREEN,
+  RATES,
+  GENERATOR_SHOP
 };
 extern GameState currentScreen;
 extern GameState lastScreen;
 
 // Non-blocking Timers
-extern unsigned long lastButtonPressTime;
 const unsigned long DEBOUNCE_DELAY = 600;
-extern unsigned long lastJoystickMoveTime;
 const unsigned long JOYSTICK_DELAY = 200;
 
+// Auto-repeat for held inputs (auto_repeat.h): one event on press, the next one
+// `delay` ms later, then every `interval` ms, each interval `accelPercent` of the
+// previous one until it reaches `minInterval`
+struct RepeatCurve {
+  unsigned int delay;
+  unsigned int interval;
+  unsigned int minInterval;
+  uint8_t accelPercent;
+};
+// Farm hold: starts at the old one click per DEBOUNCE_DELAY, reaches 10 clicks/s after ~4 s
+const RepeatCurve FARM_REPEAT = {DEBOUNCE_DELAY, DEBOUNCE_DELAY, 100, 85};
+// Cursor: a longer first delay keeps single steps easy, then up to 20 cells/s
+const RepeatCurve JOYSTICK_REPEAT = {350, JOYSTICK_DELAY, 50, 80};
+
+// Center-button gestures (gesture.h), all in ms
+struct GestureTiming {
+  unsigned int bounce;       // releases shorter than this are contact bounce
+  unsigned int doubleTapGap; // a second press within this after a release makes a double tap
+  unsigned int longPress;    // held this long is a long press
+};
+const GestureTiming CENTER_GESTURE = {30, 250, 700};
+const uint8_t BUY_MAX_LIMIT = 50; // purchases per double tap, bounds the time spent in one frame
+
+// Loop pacing (frame_pacing.h): the buttons are sampled at a fixed rate and the
+// LCD is redrawn at most once per frame with whatever changed in between, so a
+// slow redraw can't starve the input and a busy game can't flood the bus
+const unsigned long INPUT_SAMPLE_US = 1000; // 1 kHz
+#ifndef FRAME_RATE_HZ
+#define FRAME_RATE_HZ 25
+#endif
+#if VIRTUAL_TIME
+const unsigned long FRAME_INTERVAL_MS = VIRTUAL_TIME_FRAME_MS; // real time, not virtual
+#else
+const unsigned long FRAME_INTERVAL_MS = 1000 / FRAME_RATE_HZ;
+#endif
+
 // Cursor Blinking
 extern unsigned long lastBlinkTime;
 extern bool cursorVisible;
 const unsigned long BLINK_INTERVAL = 450;
 
 // Message Screen Variables
-extern char messageLine1[17];
-extern char messageLine2[17];
+// Up to one HD44780 DDRAM row (40 columns). Longer than the panel is scrolled
+// by the ticker on 2-row panels and spread over two rows on 4-row panels.
+constexpr int MESSAGE_MAX = 40;
+extern char messageLine1[MESSAGE_MAX + 1];
+extern char messageLine2[MESSAGE_MAX + 1];
 extern GameState screenAfterMessage;
 extern unsigned long messageDisplayStart;
 extern unsigned long messageTimeout; // 0 = no timeout
 
-// Prestige Bonuses
-extern int prestigeClickLevel;
-extern int prestigeAutoClickLevel;
-
 // Data Structure for EEPROM
 struct GameData {
   long cookies;
@@ -79,15 +338,59 @@ struct GameData {
   int autoClickLevel;
   int prestigeClickLevel;
   int prestigeAutoClickLevel;
+  uint8_t generatorLevels[GENERATOR_COUNT];
+  uint8_t achievements[ACHIEVEMENT_BYTES];
+};
+
+// EEPROM layout: GameData at SAVE_ADDRESS, then a SaveFooter that marks it as a
+// complete save from this firmware. The footer comes after the data so saves
+// from before it existed still load from the same address.
+const int SAVE_ADDRESS = 0;
+const int SAVE_FOOTER_ADDRESS = SAVE_ADDRESS + sizeof(GameData);
+const uint16_t SAVE_MAGIC = 0xC00D; // changes with the GameData layout
+struct SaveFooter {
+  uint16_t magic;
+  uint16_t checksum; // Fletcher-16 over the GameData bytes
+};
+enum SaveStatus {
+  SAVE_VALID,      // footer and checksum match
+  SAVE_BLANK,      // erased EEPROM, new game
+  SAVE_UNVERIFIED  // no valid footer (older firmware or damaged), loaded with the sanity clamps
+};
+
+// Session history (history_log.h): a header, then a ring of variable-length
+// records up to the end of the EEPROM. It starts well after the save so the
+// GameData layout can grow without moving it.
+const int HISTORY_HEADER_ADDRESS = 128;
+const uint16_t HISTORY_MAGIC = 0x4854; // changes with the record format
+struct HistoryHeader {
+  uint16_t magic;
+  uint16_t head; // ring offset of the next record
+  uint16_t tail; // ring offset of the oldest record; head == tail when empty
 };
+const int HISTORY_RING_ADDRESS = HISTORY_HEADER_ADDRESS + sizeof(HistoryHeader);
+#if RAM_STORAGE
+const int HISTORY_RING_SIZE = 128; // a RAM shadow in test builds (history_log.h), wraps every ~16 h
+#else
+const int HISTORY_RING_SIZE = E2END + 1 - HISTORY_RING_ADDRESS; // to the last EEPROM byte of this part
+#endif
+const unsigned long HISTORY_INTERVAL = 3600000UL; // one record per hour of play
+static_assert(SAVE_FOOTER_ADDRESS + (int)sizeof(SaveFooter) <= HISTORY_HEADER_ADDRESS, "the save runs into the history log");
+
+// Boot timing: core init (micros() == 0) to the first correct frame, measured at
+// the end of setup(); the bootloader and the global constructors come before it
+extern unsigned long bootTimeUs;
+extern SaveStatus bootSaveStatus;
 
 // UI Layout Constants
+const int BUTTON_MENU_Y = Panel::MENU_ROW;
 const int BUTTON_SHOP_X_START = 0;
 const int BUTTON_SHOP_X_END = 3;
 const int BUTTON_AUTOCLICK_X = 4;
 const int BUTTON_PRESTIGE_X = 5;
-const int BUTTON_FARM_X_START = 12;
-const int BUTTON_FARM_X_END = 15;
+const int BUTTON_GENERATOR_X = 6;
+const int BUTTON_FARM_X_START = Panel::FARM_X_START;
+const int BUTTON_FARM_X_END = Panel::LAST_X;
 
 const int BUTTON_PRESTIGE_NO_X_START = 0;
 const int BUTTON_PRESTIGE_NO_X_END = 2;
@@ -96,8 +399,11 @@ const int BUTTON_PRESTIGE_YES_X_END = 9;
 
 const int BUTTON_BACK_X = 0;
 const int BUTTON_UPGRADE_X = 0;
-const int BUTTON_SAVE_X = 15;
-const int BUTTON_RESET_X = 15;
+const int BUTTON_SAVE_X = Panel::LAST_X;
+const int BUTTON_RESET_X = Panel::LAST_X;
+const int BUTTON_RATES_X = Panel::LAST_X - 1;  // STATS row 0, next to S
+const int BUTTON_RATE_WINDOW_X = Panel::LAST_X; // RATES row 0
+const int BUTTON_NEXT_GENERATOR_X = Panel::LAST_X; // GENERATOR_SHOP row 1
 
 // Milestone Bonus Variable
 extern long nextMilestone;
@@ -109,68 +415,61 @@ const int JOY_DOWN = 4;
 const int JOY_LEFT = 5;
 const int JOY_RIGHT = 12;
 
-// Statistics
-extern long totalCookies;
-extern long totalClicks;
-extern long totalUpgrades;
+// Joystick state as a bitmask (see readJoystickButtons())
+const uint8_t JOY_MASK_CENTER = 1 << 0;
+const uint8_t JOY_MASK_UP = 1 << 1;
+const uint8_t JOY_MASK_DOWN = 1 << 2;
+const uint8_t JOY_MASK_LEFT = 1 << 3;
+const uint8_t JOY_MASK_RIGHT = 1 << 4;
+
+// Synthetic joystick input from the LCD budget scripts and the serial console
+extern uint8_t injectedButtons;
 
 // Auto-save
-extern long lastSavedCookies;
+extern unsigned long lastSaveTime;
+extern unsigned long saveCount; // saves since boot
+const unsigned long AUTOSAVE_INTERVAL = 120000; // counter drift is written at most once per 2 minutes
 
 // --- Gifts ---
-const int GIFT_POSITIONS[4] = {8, 9, 10, 11};
-const int GIFT_COUNT = 9;
-extern const char* GIFT_TEXTS[GIFT_COUNT];
-
+// One flash table row per gift (GIFTS in gifts.h): how often it spawns, what it
+// gives and the congratulations text. gifts.h samples it with the alias method,
+// so rebalancing or adding a gift is an edit to the table only.
+enum GiftKind : uint8_t {
+  GIFT_COOKIES,     // amount cookies, counted in the lifetime total
+  GIFT_CLICK_POWER, // amount more cookies per click, for good
+  GIFT_CLICK_LEVEL, // amount click levels
+  GIFT_CLICK_BONUS  // amount more cookies per click for BONUS573_TIME
+};
+struct GiftDef {
+  uint8_t weight; // relative spawn chance
+  GiftKind kind;
+  long amount;
+  char text[MESSAGE_MAX + 1];
+};
 // Gift Variables
-extern bool giftActive;
-extern int giftType;
-extern int giftPos;
 extern unsigned long lastGiftTime;
 const unsigned long GIFT_INTERVAL = 120000; // 2 minutes
 
 // Congratulations Screen
-extern bool congratsActive;
 extern unsigned long congratsStart;
 const unsigned long CONGRATS_TIME = 5000;
 
 // Temporary Bonus
-extern bool bonus573Active;
 extern unsigned long bonus573Start;
+extern int giftClickBonus; // cookies per click added while bonus573Active
 const unsigned long BONUS573_TIME = 60000;
 
 // --- Autoclicker Variables ---
-extern int autoClickLevel; // Level 0 means not purchased
+// The autoclicker and the generators pay out together on this tick
 extern unsigned long lastAutoClickTime;
 const unsigned long AUTOCLICK_INTERVAL = 1000; // 1 second
 
-extern bool needRedraw;
-
-// === Optimization: constants and screen state structure ===
-constexpr int LCD_WIDTH = 16;
-constexpr int LCD_HEIGHT = 2;
-constexpr int MAX_DIGITS = 7;
+// === Optimization: constants ===
+constexpr int MAX_DIGITS = Panel::GIFT_X_START - 1; // cookie count on MAIN, then the S button
 constexpr float UPGRADE_GROWTH = 1.15f;
 
-struct ScreenState {
-  long cookies;
-  int cookiesPerClick;
-  bool giftActive;
-  int giftPos;
-  long shopCost;
-  int shopNextClick;
-  int shopLevel;
-  long autoCost;
-  int autoIncome;
-  int autoLevel;
-  long totalCookies;
-  int statsLevel;
-  long totalUpgrades;
-  long totalClicks;
-};
-extern ScreenState prevState;
-
-// LCD object
-extern LiquidCrystal lcd;
+// LCD object (backend selected with LCD_BACKEND, see lcd_backend.h)
+#include "lcd_backend.h"
+extern LcdDevice lcd;
 
 #endif // CONFIG_H 
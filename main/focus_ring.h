@@ -0,0 +1,120 @@
+#ifndef FOCUS_RING_H
+#define FOCUS_RING_H
+
+#include "config.h"
+#include "game_logic.h"
+
+#if FOCUS_NAVIGATION
+
+// --- FOCUS NAVIGATION ---
+// Each screen's buttons as rectangles, built from the same BUTTON_* layout
+// constants handleButtonPress() tests against. A joystick step moves the
+// cursor to the nearest button in that direction, so e.g. farm -> SHOP is a
+// couple of moves instead of a dozen. A button in line with the move always
+// beats one off to the side; among those the nearest wins.
+
+struct FocusWidget {
+  uint8_t x;
+  uint8_t y;
+  uint8_t width;
+};
+
+const uint8_t FOCUS_MAX_WIDGETS = 12;
+
+uint8_t addFocusWidget(FocusWidget* widgets, uint8_t count, int x, int y, int width) {
+  if (count < FOCUS_MAX_WIDGETS) {
+    widgets[count] = {(uint8_t)x, (uint8_t)y, (uint8_t)width};
+    count++;
+  }
+  return count;
+}
+
+// The buttons on `screen` right now; returns how many
+uint8_t collectFocusWidgets(GameState screen, FocusWidget* widgets) {
+  uint8_t n = 0;
+  switch (screen) {
+    case MAIN:
+      if (game.congratsActive) break;
+      n = addFocusWidget(widgets, n, getStatsButtonX(), 0, 1); // S
+      if (game.giftActive) n = addFocusWidget(widgets, n, game.giftPos, 0, 1);
+      n = addFocusWidget(widgets, n, BUTTON_SHOP_X_START, BUTTON_MENU_Y, BUTTON_SHOP_X_END - BUTTON_SHOP_X_START + 1);
+      n = addFocusWidget(widgets, n, BUTTON_AUTOCLICK_X, BUTTON_MENU_Y, 1);
+      n = addFocusWidget(widgets, n, BUTTON_PRESTIGE_X, BUTTON_MENU_Y, 1);
+      n = addFocusWidget(widgets, n, BUTTON_GENERATOR_X, BUTTON_MENU_Y, 1);
+      for (uint8_t y = 0; y < Panel::HEIGHT; y++) {
+        n = addFocusWidget(widgets, n, BUTTON_FARM_X_START, y, BUTTON_FARM_X_END - BUTTON_FARM_X_START + 1);
+      }
+      break;
+    case SHOP:
+    case AUTOCLICK_SHOP:
+      n = addFocusWidget(widgets, n, BUTTON_UPGRADE_X, 0, 1);
+      n = addFocusWidget(widgets, n, BUTTON_BACK_X, 1, 1);
+      break;
+    case GENERATOR_SHOP:
+      n = addFocusWidget(widgets, n, BUTTON_UPGRADE_X, 0, 1);
+      n = addFocusWidget(widgets, n, BUTTON_BACK_X, 1, 1);
+      n = addFocusWidget(widgets, n, BUTTON_NEXT_GENERATOR_X, 1, 1);
+      break;
+    case PRESTIGE_CONFIRM:
+      // The hit areas reach past "NO" and "YES"; focus lands on the first letter
+      n = addFocusWidget(widgets, n, BUTTON_PRESTIGE_NO_X_START, 1, 1);
+      n = addFocusWidget(widgets, n, BUTTON_PRESTIGE_YES_X_START, 1, 1);
+      break;
+    case STATS:
+      n = addFocusWidget(widgets, n, BUTTON_RATES_X, 0, 1);
+      n = addFocusWidget(widgets, n, BUTTON_SAVE_X, 0, 1);
+      n = addFocusWidget(widgets, n, BUTTON_BACK_X, 1, 1);
+      n = addFocusWidget(widgets, n, BUTTON_RESET_X, 1, 1);
+      break;
+    case RATES:
+      n = addFocusWidget(widgets, n, BUTTON_BACK_X, 0, 1);
+      n = addFocusWidget(widgets, n, BUTTON_RATE_WINDOW_X, 0, 1);
+      break;
+    case MESSAGE_SCREEN:
+      break;
+  }
+  return n;
+}
+
+// Move the cursor one button in `direction` (a single JOY_MASK_* bit).
+// Returns false if the screen has no buttons and the caller should step a cell.
+bool moveFocus(uint8_t direction) {
+  FocusWidget widgets[FOCUS_MAX_WIDGETS];
+  uint8_t count = collectFocusWidgets(currentScreen, widgets);
+  if (count == 0) return false;
+
+  int bestScore = INT_MAX;
+  int bestX = cursorX;
+  int bestY = cursorY;
+  for (uint8_t i = 0; i < count; i++) {
+    const FocusWidget& w = widgets[i];
+    // The widget cell closest to the cursor
+    int x = constrain(cursorX, w.x, w.x + w.width - 1);
+    int y = w.y;
+    if (x == cursorX && y == cursorY) continue; // the widget under the cursor
+
+    int along;
+    int across;
+    switch (direction) {
+      case JOY_MASK_RIGHT: along = x - cursorX; across = abs(y - cursorY); break;
+      case JOY_MASK_LEFT:  along = cursorX - x; across = abs(y - cursorY); break;
+      case JOY_MASK_DOWN:  along = y - cursorY; across = abs(x - cursorX); break;
+      case JOY_MASK_UP:    along = cursorY - y; across = abs(x - cursorX); break;
+      default: return true;
+    }
+    if (along <= 0) continue;
+    int score = along + across * Panel::WIDTH;
+    if (score < bestScore) {
+      bestScore = score;
+      bestX = x;
+      bestY = y;
+    }
+  }
+  cursorX = bestX;
+  cursorY = bestY;
+  return true;
+}
+
+#endif // FOCUS_NAVIGATION
+
+#endif // FOCUS_RING_H
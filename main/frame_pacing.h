@@ -0,0 +1,71 @@
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+#include "config.h"
+#include "game_state.h"
+#include "ui_screens.h"
+#include "ticker.h"
+
+// --- LOOP PACING ---
+// loop() runs the game logic on every pass but splits the rest into two fixed
+// cadences: input is sampled every INPUT_SAMPLE_US and the LCD is redrawn every
+// FRAME_INTERVAL_MS. Everything that changes between frames only sets dirty
+// bits, so a frame draws the coalesced result once. Both clocks keep their
+// schedule; after a stall they skip the missed slots instead of bursting.
+
+unsigned long nextInputUs = 0;
+unsigned long nextFrameMs = 0;
+unsigned long frameCount = 0;
+unsigned long frameOverruns = 0;  // frames that started a whole interval or more late
+unsigned long worstFrameUs = 0;   // longest single renderFrame()
+
+// True when the buttons should be read on this pass
+bool inputSampleDue() {
+#if VIRTUAL_TIME
+  // The virtual clock already steps in whole milliseconds
+  return true;
+#else
+  unsigned long now = micros();
+  if ((long)(now - nextInputUs) < 0) return false;
+  nextInputUs += INPUT_SAMPLE_US;
+  if ((long)(now - nextInputUs) >= 0) nextInputUs = now + INPUT_SAMPLE_US;
+  return true;
+#endif
+}
+
+// True when a frame should be drawn on this pass (real time, even with VIRTUAL_TIME)
+bool frameDue() {
+  unsigned long now = millis();
+  if ((long)(now - nextFrameMs) < 0) return false;
+  nextFrameMs += FRAME_INTERVAL_MS;
+  if ((long)(now - nextFrameMs) >= 0) {
+    if (frameCount > 0) frameOverruns++;
+    nextFrameMs = now + FRAME_INTERVAL_MS;
+  }
+  return true;
+}
+
+// All LCD traffic of one frame: the screen change, the ticker step and the redraw
+void renderFrame() {
+  unsigned long start = micros();
+
+  // Clear LCD and redraw everything if screen changed
+  if (currentScreen != lastScreen) {
+    stopTicker();
+    lcd.clear();
+    lastScreen = currentScreen;
+    requestFullRedraw();
+    // Reset cursor position for new screen
+    prevCursorX = -1;
+    prevCursorY = -1;
+  }
+  tickerTick();
+  // Draws only what the dirty bits say changed (and the cursor)
+  displayManager();
+
+  unsigned long elapsed = micros() - start;
+  if (elapsed > worstFrameUs) worstFrameUs = elapsed;
+  frameCount++;
+}
+
+#endif // FRAME_PACING_H
@@ -6,14 +6,28 @@
 // Forward declarations
 int getAutoClickPower(int level);
 
-// Optimized getDigitCount
-int getDigitCount(long number) {
-  int count = 1;
-  while (number >= 10 && count < MAX_DIGITS) {
-    number /= 10;
-    count++;
+// `number` in at most `width` characters: exact while it fits, then in
+// thousands (K), millions (M) or billions (B) like printBigNumber(). Returns the length.
+int formatShortNumber(char* buf, size_t size, long number, int width) {
+  const char units[] = "KMB";
+  int len = snprintf(buf, size, "%ld", number);
+  for (uint8_t unit = 0; len > width && unit < sizeof(units) - 1; unit++) {
+    number /= 1000;
+    len = snprintf(buf, size, "%ld%c", number, units[unit]);
   }
-  return count;
+  return len;
+}
+
+// The cookie count as MAIN shows it, at most MAX_DIGITS wide. Returns the
+// length, which is also the column of the S button.
+int formatCookieCount(char* buf, size_t size, long number) {
+  return formatShortNumber(buf, size, number, MAX_DIGITS);
+}
+
+// Column of the S (stats) button, right after the cookie count
+int getStatsButtonX() {
+  char buf[12];
+  return formatCookieCount(buf, sizeof(buf), game.cookies);
 }
 
 // Helper function: calculate level
@@ -27,7 +41,7 @@ int getNextClickPower(int clickPower) {
 }
 
 long long calculateUpgradeCost() {
-  int level = getLevel(cookiesPerClick);
+  int level = getLevel(game.cookiesPerClick);
   
   // New algorithm: exponential growth.
   // Base cost 100, each level is 15% more expensive.
@@ -48,7 +62,7 @@ long long calculateUpgradeCost() {
 }
 
 long long calculateAutoClickUpgradeCost() {
-  int safeLevel = autoClickLevel < 0 ? 0 : autoClickLevel;
+  int safeLevel = game.autoClickLevel < 0 ? 0 : game.autoClickLevel;
   // Fixed price for the first purchase
   if (safeLevel == 0) return 1000;
   int power = getAutoClickPower(safeLevel + 1); // Calculate for the next level
@@ -57,6 +71,11 @@ long long calculateAutoClickUpgradeCost() {
   return cost;
 }
 
+// Cookies for one farm click, including the temporary bonus gift
+int getClickValue() {
+  return game.bonus573Active ? (game.cookiesPerClick + giftClickBonus) : game.cookiesPerClick;
+}
+
 int getAutoClickPower(int level) {
   if (level == 0) return 0; // If not purchased, power is 0
   if (level == 1) return 1;
@@ -64,4 +83,46 @@ int getAutoClickPower(int level) {
   return 1 + (14 * 2) + (level - 15) * 4;
 }
 
+// Price of the next building of this type. Past LONG_MAX, which the saturated
+// cookie counter can never pay, it stops growing.
+long long calculateGeneratorCost(uint8_t type) {
+  GeneratorDef def = readGenerator(type);
+  long long cost = def.baseCost;
+  for (uint8_t i = 0; i < game.generatorLevels[type] && cost <= LONG_MAX; i++) {
+    cost = cost * def.growthPercent / 100;
+  }
+  return cost;
+}
+
+// Whether the next building of this type can ever be bought
+bool isGeneratorMaxed(uint8_t type) {
+  return game.generatorLevels[type] >= GENERATOR_MAX_LEVEL || calculateGeneratorCost(type) > LONG_MAX;
+}
+
+// Autoclicker plus every generator, per AUTOCLICK_INTERVAL. Only called when a
+// level changes; the tick itself adds the cached game.passiveIncome.
+long computePassiveIncome() {
+  long income = getAutoClickPower(game.autoClickLevel);
+  for (uint8_t type = 0; type < GENERATOR_COUNT; type++) {
+    income += (long)game.generatorLevels[type] * readGenerator(type).yield;
+  }
+  return income;
+}
+
+// Milestones are the powers of ten from 100 up; reaching one doubles the cookies
+const long MILESTONES[] PROGMEM = {
+  100L, 1000L, 10000L, 100000L, 1000000L, 10000000L, 100000000L, 1000000000L
+};
+const uint8_t MILESTONE_COUNT = sizeof(MILESTONES) / sizeof(MILESTONES[0]);
+
+// First milestone above `cookies`, or -1 past the last one. At most eight
+// compares, so boot and the console don't have to multiply their way up.
+long milestoneAfter(long cookies) {
+  for (uint8_t i = 0; i < MILESTONE_COUNT; i++) {
+    long milestone = pgm_read_dword(&MILESTONES[i]);
+    if (milestone > cookies) return milestone;
+  }
+  return -1;
+}
+
 #endif // GAME_LOGIC_H 
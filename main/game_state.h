@@ -0,0 +1,188 @@
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include "config.h"
+#include "game_logic.h"
+#include "rate_stats.h"
+
+// Forward declarations (achievements.h, history_log.h)
+void checkAchievement(AchievementCounter counter, long value);
+void foldHistoryTotals();
+
+// --- GAME STATE MUTATORS ---
+// The only code that writes to `game`. Each mutator flags what it changed so the
+// renderers redraw just those fields and the save system knows when to persist.
+
+inline void markDirty(uint16_t bits) {
+  game.dirty |= bits;
+  game.unsaved |= bits & DIRTY_PERSISTENT;
+}
+
+// Redraw everything on the next frame (screen change, overlay, clear)
+inline void requestFullRedraw() {
+  game.dirty |= DIRTY_SCREEN;
+}
+
+// Render check: true if any of `bits` changed or the whole screen is stale
+inline bool isDirty(uint16_t bits) {
+  return game.dirty & (bits | DIRTY_SCREEN);
+}
+
+// Counters saturate instead of wrapping into negative numbers
+long saturatingAdd(long value, long amount) {
+  if (amount > 0 && value > LONG_MAX - amount) return LONG_MAX;
+  return value + amount;
+}
+
+void setCookies(long value) {
+  if (game.cookies == value) return;
+  game.cookies = value;
+  markDirty(DIRTY_COOKIES);
+  checkAchievement(ACH_COOKIES, value);
+}
+
+// Income that does not count towards the lifetime total (autoclicker)
+void addCookies(long amount) {
+  setCookies(saturatingAdd(game.cookies, amount));
+}
+
+// Income that counts towards the lifetime total (clicks, gifts)
+void earnCookies(long amount) {
+  addCookies(amount);
+  game.totalCookies = saturatingAdd(game.totalCookies, amount);
+  markDirty(DIRTY_TOTAL_COOKIES);
+}
+
+void recordClick(long amount) {
+  earnCookies(amount);
+  game.totalClicks++;
+  markDirty(DIRTY_TOTAL_CLICKS);
+  checkAchievement(ACH_CLICKS, game.totalClicks);
+  recordManualRate(amount);
+}
+
+// Autoclicker and generator income, tracked separately from clicks in the rate stats
+void collectPassiveIncome() {
+  addCookies(game.passiveIncome);
+  recordAutoRate(game.passiveIncome);
+}
+
+// Called by every mutator that changes a level feeding passiveIncome
+void updatePassiveIncome() {
+  game.passiveIncome = computePassiveIncome();
+}
+
+// Returns false and changes nothing if the player can't afford it
+bool spendCookies(long long cost) {
+  if (game.cookies < cost) return false;
+  setCookies(game.cookies - cost);
+  return true;
+}
+
+void setCookiesPerClick(int value) {
+  if (game.cookiesPerClick == value) return;
+  game.cookiesPerClick = value;
+  markDirty(DIRTY_CLICK_POWER);
+}
+
+void addUpgrade() {
+  game.totalUpgrades++;
+  markDirty(DIRTY_TOTAL_UPGRADES);
+  checkAchievement(ACH_UPGRADES, game.totalUpgrades);
+}
+
+void setAutoClickLevel(int level) {
+  if (game.autoClickLevel == level) return;
+  game.autoClickLevel = level;
+  updatePassiveIncome();
+  markDirty(DIRTY_AUTOCLICK);
+  checkAchievement(ACH_AUTOCLICK, level);
+}
+
+void setGeneratorLevel(uint8_t type, uint8_t level) {
+  if (game.generatorLevels[type] == level) return;
+  game.generatorLevels[type] = level;
+  updatePassiveIncome();
+  markDirty(DIRTY_GENERATORS);
+}
+
+void resetGenerators() {
+  for (uint8_t type = 0; type < GENERATOR_COUNT; type++) {
+    setGeneratorLevel(type, 0);
+  }
+}
+
+void setPrestigeLevels(int clickLevel, int autoClickLevel) {
+  if (game.prestigeClickLevel == clickLevel && game.prestigeAutoClickLevel == autoClickLevel) return;
+  game.prestigeClickLevel = clickLevel;
+  game.prestigeAutoClickLevel = autoClickLevel;
+  markDirty(DIRTY_PRESTIGE);
+  checkAchievement(ACH_PRESTIGE, clickLevel);
+}
+
+void resetTotals() {
+  foldHistoryTotals(); // the history keeps what was earned before the reset
+  game.totalCookies = 0;
+  game.totalClicks = 0;
+  game.totalUpgrades = 0;
+  markDirty(DIRTY_TOTAL_COOKIES | DIRTY_TOTAL_CLICKS | DIRTY_TOTAL_UPGRADES);
+}
+
+void spawnGift(int type, int pos) {
+  game.giftActive = true;
+  game.giftType = type;
+  game.giftPos = pos;
+  markDirty(DIRTY_GIFT);
+}
+
+void clearGift() {
+  if (!game.giftActive) return;
+  game.giftActive = false;
+  markDirty(DIRTY_GIFT);
+}
+
+void setBonus573(bool active) {
+  if (game.bonus573Active == active) return;
+  game.bonus573Active = active;
+  markDirty(DIRTY_BONUS);
+}
+
+void setCongrats(bool active) {
+  if (game.congratsActive == active) return;
+  game.congratsActive = active;
+  markDirty(DIRTY_CONGRATS);
+}
+
+// Replace the persistent fields with a loaded save; nothing is unsaved afterwards
+void loadGame(const GameData& data) {
+  game.cookies = data.cookies;
+  game.cookiesPerClick = data.cookiesPerClick;
+  game.totalCookies = data.totalCookies;
+  game.totalClicks = data.totalClicks;
+  game.totalUpgrades = data.totalUpgrades;
+  game.autoClickLevel = data.autoClickLevel;
+  game.prestigeClickLevel = data.prestigeClickLevel;
+  game.prestigeAutoClickLevel = data.prestigeAutoClickLevel;
+  memcpy(game.generatorLevels, data.generatorLevels, sizeof(game.generatorLevels));
+  memcpy(game.achievements, data.achievements, sizeof(game.achievements));
+
+  // Sanity checks for loaded data
+  if (game.cookies < 0) game.cookies = 0;
+  if (game.cookiesPerClick < 1) game.cookiesPerClick = 1;
+  if (game.totalCookies < 0) game.totalCookies = 0;
+  if (game.totalClicks < 0) game.totalClicks = 0;
+  if (game.totalUpgrades < 0) game.totalUpgrades = 0;
+  if (game.autoClickLevel < 0) game.autoClickLevel = 0;
+  if (game.prestigeClickLevel < 1) game.prestigeClickLevel = 1;
+  if (game.prestigeAutoClickLevel < 0) game.prestigeAutoClickLevel = 0;
+  // Saves from before the generators have erased (0xFF) bytes here
+  for (uint8_t type = 0; type < GENERATOR_COUNT; type++) {
+    if (game.generatorLevels[type] > GENERATOR_MAX_LEVEL) game.generatorLevels[type] = 0;
+  }
+  updatePassiveIncome();
+
+  requestFullRedraw();
+  game.unsaved = 0;
+}
+
+#endif // GAME_STATE_H
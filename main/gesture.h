@@ -0,0 +1,77 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include "config.h"
+
+// --- BUTTON GESTURES ---
+// Turns one button into tap / double-tap / long-press events, polled once per
+// input sample like AutoRepeat. A long press fires while the button is still
+// down, once it has been held GestureTiming::longPress; letting go after that
+// gives GESTURE_HOLD_RELEASE instead of a tap. A tap fires on release, or
+// doubleTapGap later when the caller says a double tap is bound there, so
+// screens without a double-tap binding never wait for one.
+
+enum GestureEvent : uint8_t {
+  GESTURE_NONE,
+  GESTURE_TAP,
+  GESTURE_DOUBLE_TAP,
+  GESTURE_LONG_PRESS,
+  GESTURE_HOLD_RELEASE
+};
+
+class Gesture {
+public:
+  explicit Gesture(const GestureTiming& timing) : timing_(timing) {}
+
+  GestureEvent update(bool held, unsigned long now, bool doubleTapBound) {
+    if (held) {
+      lastHeld_ = now;
+      if (!down_) {
+        down_ = true;
+        pressStart_ = now;
+        longFired_ = false;
+      } else if (!longFired_ && now - pressStart_ >= timing_.longPress) {
+        longFired_ = true;
+        tapPending_ = false;
+        return GESTURE_LONG_PRESS;
+      }
+      return GESTURE_NONE;
+    }
+
+    // A release shorter than `bounce` is contact bounce, not a new press
+    if (down_ && now - lastHeld_ >= timing_.bounce) {
+      down_ = false;
+      if (longFired_) return GESTURE_HOLD_RELEASE;
+      if (tapPending_) {
+        tapPending_ = false;
+        return GESTURE_DOUBLE_TAP;
+      }
+      if (!doubleTapBound) return GESTURE_TAP;
+      tapPending_ = true;
+      releasedAt_ = now;
+      return GESTURE_NONE;
+    }
+    // No second press in time: it was a single tap after all
+    if (tapPending_ && !down_ && now - releasedAt_ >= timing_.doubleTapGap) {
+      tapPending_ = false;
+      return GESTURE_TAP;
+    }
+    return GESTURE_NONE;
+  }
+
+  // A tap released and held back until doubleTapGap tells it from a double tap
+  bool tapPending() const {
+    return tapPending_;
+  }
+
+private:
+  const GestureTiming& timing_;
+  bool down_ = false;
+  bool longFired_ = false;
+  bool tapPending_ = false;
+  unsigned long pressStart_ = 0;
+  unsigned long lastHeld_ = 0;
+  unsigned long releasedAt_ = 0;
+};
+
+#endif // GESTURE_H
@@ -0,0 +1,112 @@
+#ifndef GIFTS_H
+#define GIFTS_H
+
+#include "config.h"
+
+// --- GIFT SAMPLING ---
+// Gifts are drawn from the GIFTS weights with the alias method: the table is
+// split once at boot into GIFT_COUNT columns, each holding at most two gifts,
+// and a draw is one random column plus one biased coin. The cost is the same
+// for any table size. The random numbers come from xorshift32: three shifts and
+// XORs per number, with ranges mapped by multiplication instead of random()'s
+// division.
+
+// The gifts (GiftDef in config.h). GIFT_COUNT follows the table, so a new gift is
+// one more row here.
+const GiftDef GIFTS[] PROGMEM = {
+  // weight kind           amount  text
+  {10, GIFT_COOKIES,        100, "+100 cookies"},
+  {10, GIFT_COOKIES,        500, "+500 cookies"},
+  {10, GIFT_COOKIES,       1000, "+1000 cookies"},
+  {10, GIFT_COOKIES,       5000, "+5000 cookies"},
+  {10, GIFT_COOKIES,      10000, "+10000 cookies"},
+  {10, GIFT_COOKIES,      15000, "+15000 cookies"},
+  {10, GIFT_CLICK_POWER,     50, "+50 cookies per click, for good"},
+  {10, GIFT_CLICK_LEVEL,      1, "+1 click level"},
+  {10, GIFT_CLICK_BONUS,    573, "+573 cookies per click for 60 seconds"}
+};
+const uint8_t GIFT_COUNT = sizeof(GIFTS) / sizeof(GIFTS[0]);
+
+inline GiftDef readGift(uint8_t type) {
+  GiftDef def;
+  memcpy_P(&def, &GIFTS[type], sizeof(def));
+  return def;
+}
+
+const uint16_t GIFT_COIN_SCALE = 256; // giftProbability 256 = the column is never aliased
+
+uint32_t giftRandomState = 1;
+uint16_t giftProbability[GIFT_COUNT]; // chance of keeping the column, out of GIFT_COIN_SCALE
+uint8_t giftAlias[GIFT_COUNT];        // gift drawn otherwise
+
+// Any seed works except 0, which xorshift would never leave
+void seedGiftRandom(uint32_t seed) {
+  giftRandomState = seed != 0 ? seed : 1;
+}
+
+uint32_t giftRandom() {
+  uint32_t x = giftRandomState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  giftRandomState = x;
+  return x;
+}
+
+// Uniform in [0, n) for n up to 65535
+uint16_t giftRandomBelow(uint16_t n) {
+  return ((giftRandom() >> 16) * n) >> 16;
+}
+
+// Vose's construction in integers: a gift's share is weight * GIFT_COUNT
+// against the total weight, which is the average column's share
+void buildGiftTable() {
+  long share[GIFT_COUNT];
+  uint8_t small[GIFT_COUNT];
+  uint8_t large[GIFT_COUNT];
+  uint8_t smallCount = 0;
+  uint8_t largeCount = 0;
+  long total = 0;
+
+  for (uint8_t type = 0; type < GIFT_COUNT; type++) {
+    total += pgm_read_byte(&GIFTS[type].weight);
+  }
+  for (uint8_t type = 0; type < GIFT_COUNT; type++) {
+    share[type] = (long)pgm_read_byte(&GIFTS[type].weight) * GIFT_COUNT;
+    giftAlias[type] = type;
+    if (share[type] < total) {
+      small[smallCount++] = type;
+    } else {
+      large[largeCount++] = type;
+    }
+  }
+  // Fill each short column with the top of a tall one
+  while (smallCount > 0 && largeCount > 0) {
+    uint8_t low = small[--smallCount];
+    uint8_t high = large[--largeCount];
+    giftProbability[low] = share[low] * GIFT_COIN_SCALE / total;
+    giftAlias[low] = high;
+    share[high] -= total - share[low];
+    if (share[high] < total) {
+      small[smallCount++] = high;
+    } else {
+      large[largeCount++] = high;
+    }
+  }
+  // Whatever is left is full up to rounding
+  while (largeCount > 0) giftProbability[large[--largeCount]] = GIFT_COIN_SCALE;
+  while (smallCount > 0) giftProbability[small[--smallCount]] = GIFT_COIN_SCALE;
+}
+
+uint8_t pickGiftType() {
+  uint32_t r = giftRandom();
+  uint8_t column = ((r >> 16) * GIFT_COUNT) >> 16;
+  uint8_t coin = r & 0xFF;
+  return coin < giftProbability[column] ? column : giftAlias[column];
+}
+
+void readGiftText(uint8_t type, char* buf) {
+  strcpy_P(buf, GIFTS[type].text);
+}
+
+#endif // GIFTS_H
@@ -0,0 +1,403 @@
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include "config.h"
+#include "game_state.h"
+
+// --- SESSION HISTORY LOG ---
+// A ring of small records in the EEPROM after the save (HISTORY_* in config.h):
+//
+//   session  written at boot: lifetime cookies, clicks, upgrades, prestige level
+//            and how long the previous session ran, in seconds, from the
+//            watchdog breadcrumbs (0 after a power cut, which loses them)
+//   hour     written every HISTORY_INTERVAL of play: minutes covered and the
+//            cookies, clicks, upgrades and prestiges of that hour
+//
+// A record is a kind byte and then LEB128 varints, so an hour of light play is
+// 6-8 bytes. Hours hold deltas and sessions hold the totals they start from, so
+// the reader can rebuild the totals and see what a session lost since its last
+// hour record; the uptime covers sessions shorter than an hour and the partial
+// last hour of every session. Records never straddle the end of the ring; a HISTORY_WRAP byte
+// sends the reader back to the start. When the ring is full the oldest records
+// are dropped. The header moves once per record, so the EEPROM is written at
+// most once per hour after boot.
+
+enum HistoryRecordKind : uint8_t {
+  HISTORY_WRAP = 0, // rest of the ring unused, continue at offset 0
+  HISTORY_SESSION = 1,
+  HISTORY_HOUR = 2
+};
+const uint8_t HISTORY_VARINT_MAX = 5; // bytes for a 32-bit value
+const uint8_t HISTORY_FIELDS_MAX = 5;
+const uint8_t HISTORY_RECORD_MAX = 1 + HISTORY_FIELDS_MAX * HISTORY_VARINT_MAX;
+static_assert(HISTORY_RING_SIZE >= 4 * HISTORY_RECORD_MAX, "no room for the history log in this part's EEPROM");
+
+struct HistoryTotals {
+  long cookies;
+  long clicks;
+  long upgrades;
+};
+
+HistoryHeader historyHeader;
+HistoryTotals historyBase;  // lifetime totals when the hour started, zeroed by a reset
+HistoryTotals historyCarry; // earned this hour before a reset
+uint8_t historyPrestiges = 0;
+unsigned long historyHourStart = 0;
+
+unsigned long historyWrites = 0; // header writes since boot, one per record
+
+#if RAM_STORAGE
+// Test builds keep the ring and its header in RAM and only count the writes: a
+// virtual week would rewrite the same EEPROM cells thousands of times, and the
+// budget scripts' sessions are not the unit's history
+uint8_t historyShadow[HISTORY_RING_SIZE];
+
+uint8_t readHistoryByte(uint16_t offset) {
+  return historyShadow[offset];
+}
+
+void writeHistoryByte(uint16_t offset, uint8_t value) {
+  historyShadow[offset] = value;
+}
+
+void loadHistoryHeader() {
+  historyHeader = {HISTORY_MAGIC, 0, 0};
+}
+
+void saveHistoryHeader() {
+  historyWrites++;
+}
+#else
+uint8_t readHistoryByte(uint16_t offset) {
+  return EEPROM.read(HISTORY_RING_ADDRESS + offset);
+}
+
+void writeHistoryByte(uint16_t offset, uint8_t value) {
+  EEPROM.update(HISTORY_RING_ADDRESS + offset, value);
+}
+
+void loadHistoryHeader() {
+  EEPROM.get(HISTORY_HEADER_ADDRESS, historyHeader);
+}
+
+void saveHistoryHeader() {
+  EEPROM.put(HISTORY_HEADER_ADDRESS, historyHeader);
+  historyWrites++;
+}
+#endif
+
+uint8_t historyFieldCount(uint8_t kind) {
+  if (kind == HISTORY_SESSION) return 5;
+  if (kind == HISTORY_HOUR) return 5;
+  return 0;
+}
+
+uint8_t putHistoryVarint(uint8_t* buf, uint8_t length, unsigned long value) {
+  while (value >= 0x80) {
+    buf[length++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  buf[length++] = value;
+  return length;
+}
+
+// Reads one varint at ring offset `offset` and moves past it; false if it is
+// malformed or runs off the end of the ring
+bool readHistoryVarint(uint16_t& offset, unsigned long& value) {
+  value = 0;
+  for (uint8_t i = 0; i < HISTORY_VARINT_MAX && offset < HISTORY_RING_SIZE; i++) {
+    uint8_t b = readHistoryByte(offset++);
+    value |= (unsigned long)(b & 0x7F) << (7 * i);
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+// Length of the record at `offset`, or 0 if it isn't a valid record
+uint8_t historyRecordLength(uint16_t offset) {
+  uint16_t start = offset;
+  uint8_t fields = historyFieldCount(readHistoryByte(offset++));
+  if (fields == 0) return 0;
+  unsigned long value;
+  for (uint8_t i = 0; i < fields; i++) {
+    if (!readHistoryVarint(offset, value)) return 0;
+  }
+  return offset - start;
+}
+
+
+void clearHistory() {
+  historyHeader = {HISTORY_MAGIC, 0, 0};
+  saveHistoryHeader();
+}
+
+// The step from `offset` to the next record, or false for a broken ring
+bool nextHistoryOffset(uint16_t& offset) {
+  if (readHistoryByte(offset) == HISTORY_WRAP) {
+    offset = 0;
+    return true;
+  }
+  uint8_t length = historyRecordLength(offset);
+  offset += length;
+  return length > 0 && offset < HISTORY_RING_SIZE;
+}
+
+void dropOldestHistoryRecord() {
+  if (!nextHistoryOffset(historyHeader.tail)) {
+    historyHeader.tail = historyHeader.head; // unreadable: give up on the old records
+  }
+}
+
+void appendHistoryRecord(const uint8_t* record, uint8_t length) {
+  HistoryHeader& h = historyHeader;
+  if (h.head + length >= HISTORY_RING_SIZE) {
+    // Wrap: everything between head and the end of the ring goes first
+    while (h.tail > h.head) dropOldestHistoryRecord();
+    writeHistoryByte(h.head, HISTORY_WRAP);
+    if (h.tail == h.head) {
+      h.tail = 0; // empty
+    } else if (h.tail == 0) {
+      dropOldestHistoryRecord(); // the new head would land on the oldest record
+    }
+    h.head = 0;
+  }
+  // Make room ahead of head; head must stay short of tail
+  while (h.tail > h.head && h.tail <= h.head + length) dropOldestHistoryRecord();
+  for (uint8_t i = 0; i < length; i++) {
+    writeHistoryByte(h.head + i, record[i]);
+  }
+  h.head += length;
+  saveHistoryHeader();
+}
+
+HistoryTotals currentHistoryTotals() {
+  return {game.totalCookies, game.totalClicks, game.totalUpgrades};
+}
+
+// Called by resetTotals() before the lifetime totals go back to 0
+void foldHistoryTotals() {
+  HistoryTotals now = currentHistoryTotals();
+  historyCarry.cookies += now.cookies - historyBase.cookies;
+  historyCarry.clicks += now.clicks - historyBase.clicks;
+  historyCarry.upgrades += now.upgrades - historyBase.upgrades;
+  historyBase = {0, 0, 0};
+}
+
+// What the hour in progress has earned so far
+HistoryTotals hourHistoryTotals() {
+  HistoryTotals now = currentHistoryTotals();
+  HistoryTotals hour = {
+    historyCarry.cookies + now.cookies - historyBase.cookies,
+    historyCarry.clicks + now.clicks - historyBase.clicks,
+    historyCarry.upgrades + now.upgrades - historyBase.upgrades
+  };
+  // Only a console edit can lower a total without a reset; log that as nothing
+  if (hour.cookies < 0) hour.cookies = 0;
+  if (hour.clicks < 0) hour.clicks = 0;
+  if (hour.upgrades < 0) hour.upgrades = 0;
+  return hour;
+}
+
+void noteHistoryPrestige() {
+  if (historyPrestiges < 255) historyPrestiges++;
+}
+
+// Called once in setup(), after the save is loaded: check the ring and open a
+// session. `lastUptimeS` is how long the previous session ran, 0 if unknown.
+void beginHistory(unsigned long lastUptimeS) {
+  loadHistoryHeader();
+  bool valid = historyHeader.magic == HISTORY_MAGIC &&
+               historyHeader.head < HISTORY_RING_SIZE && historyHeader.tail < HISTORY_RING_SIZE;
+  // Walk it once; a torn or foreign ring is cleared rather than misread
+  for (uint16_t offset = historyHeader.tail, steps = 0; valid && offset != historyHeader.head; steps++) {
+    valid = steps < HISTORY_RING_SIZE && nextHistoryOffset(offset);
+  }
+  if (!valid) clearHistory();
+
+  historyBase = currentHistoryTotals();
+  historyHourStart = nowMs();
+  uint8_t record[HISTORY_RECORD_MAX];
+  uint8_t length = 0;
+  record[length++] = HISTORY_SESSION;
+  length = putHistoryVarint(record, length, historyBase.cookies);
+  length = putHistoryVarint(record, length, historyBase.clicks);
+  length = putHistoryVarint(record, length, historyBase.upgrades);
+  length = putHistoryVarint(record, length, game.prestigeClickLevel);
+  length = putHistoryVarint(record, length, lastUptimeS);
+  appendHistoryRecord(record, length);
+}
+
+// Called once per loop(); writes the hour record when the hour is up
+void historyTick() {
+  unsigned long elapsed = nowMs() - historyHourStart;
+  if (elapsed < HISTORY_INTERVAL) return;
+
+  HistoryTotals hour = hourHistoryTotals();
+  uint8_t record[HISTORY_RECORD_MAX];
+  uint8_t length = 0;
+  record[length++] = HISTORY_HOUR;
+  length = putHistoryVarint(record, length, elapsed / 60000UL); // more than 60 after a stall
+  length = putHistoryVarint(record, length, hour.cookies);
+  length = putHistoryVarint(record, length, hour.clicks);
+  length = putHistoryVarint(record, length, hour.upgrades);
+  length = putHistoryVarint(record, length, historyPrestiges);
+  appendHistoryRecord(record, length);
+
+  historyBase = currentHistoryTotals();
+  historyCarry = {0, 0, 0};
+  historyPrestiges = 0;
+  historyHourStart += elapsed;
+}
+
+#if SERIAL_CONSOLE || HISTORY_SERIAL
+
+void printHistorySums(const unsigned long* sums) {
+  Serial.print(F("sum"));
+  for (uint8_t i = 0; i < historyFieldCount(HISTORY_HOUR); i++) {
+    Serial.print(' ');
+    Serial.print(sums[i]);
+  }
+  Serial.println();
+}
+
+// One line per record, oldest first, and each session's hours added up. The
+// console and the reader below print it one line per pass: beginHistoryDump(),
+// then dumpHistoryLine() until it returns false.
+enum HistoryDumpStep : uint8_t {
+  HISTORY_DUMP_LEGEND,
+  HISTORY_DUMP_LEGEND_HOURS,
+  HISTORY_DUMP_RECORDS,
+  HISTORY_DUMP_NOW,
+  HISTORY_DUMP_DONE
+};
+
+HistoryDumpStep historyDumpStep;
+uint16_t historyDumpOffset;
+unsigned long historyDumpSums[HISTORY_FIELDS_MAX];
+uint16_t historyDumpHours;
+
+void beginHistoryDump() {
+  historyDumpStep = HISTORY_DUMP_LEGEND;
+  historyDumpOffset = historyHeader.tail;
+  memset(historyDumpSums, 0, sizeof(historyDumpSums));
+  historyDumpHours = 0;
+}
+
+// A session's hours added up, before the next session or the end
+void dumpHistorySums() {
+  printHistorySums(historyDumpSums);
+  memset(historyDumpSums, 0, sizeof(historyDumpSums));
+  historyDumpHours = 0;
+}
+
+// Prints the next line; false once the dump is complete
+bool dumpHistoryLine() {
+  switch (historyDumpStep) {
+    case HISTORY_DUMP_LEGEND:
+      Serial.println(F("# session total_cookies total_clicks total_upgrades prestige_level last_uptime_s"));
+      historyDumpStep = HISTORY_DUMP_LEGEND_HOURS;
+      return true;
+
+    case HISTORY_DUMP_LEGEND_HOURS:
+      Serial.println(F("# hour|sum|now min cookies clicks upgrades prestiges"));
+      historyDumpStep = HISTORY_DUMP_RECORDS;
+      return true;
+
+    case HISTORY_DUMP_RECORDS: {
+      uint16_t& offset = historyDumpOffset;
+      if (offset != historyHeader.head && readHistoryByte(offset) == HISTORY_WRAP) {
+        offset = 0;
+      }
+      if (offset != historyHeader.head) {
+        uint8_t kind = readHistoryByte(offset);
+        if (kind == HISTORY_SESSION && historyDumpHours > 0) {
+          dumpHistorySums(); // the session itself goes on the next line
+          return true;
+        }
+        offset++;
+        Serial.print(kind == HISTORY_SESSION ? F("session") : F("hour"));
+        for (uint8_t i = 0; i < historyFieldCount(kind); i++) {
+          unsigned long value;
+          readHistoryVarint(offset, value);
+          Serial.print(' ');
+          Serial.print(value);
+          if (kind == HISTORY_HOUR) historyDumpSums[i] += value;
+        }
+        Serial.println();
+        if (kind == HISTORY_HOUR) historyDumpHours++;
+        return true;
+      }
+      historyDumpStep = HISTORY_DUMP_NOW;
+      if (historyDumpHours > 0) {
+        dumpHistorySums();
+        return true;
+      }
+    }
+      // fall through
+
+    case HISTORY_DUMP_NOW: {
+      // The hour in progress, not logged yet
+      HistoryTotals hour = hourHistoryTotals();
+      Serial.print(F("now "));
+      Serial.print((nowMs() - historyHourStart) / 60000UL);
+      Serial.print(' ');
+      Serial.print(hour.cookies);
+      Serial.print(' ');
+      Serial.print(hour.clicks);
+      Serial.print(' ');
+      Serial.print(hour.upgrades);
+      Serial.print(' ');
+      Serial.println(historyPrestiges);
+      historyDumpStep = HISTORY_DUMP_DONE;
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+#if !SERIAL_CONSOLE
+// --- READ-ONLY HISTORY READER ---
+// Without the console, the only thing Serial answers is a "history" line. Any
+// other line is ignored.
+const char HISTORY_COMMAND[] PROGMEM = "history";
+const uint8_t HISTORY_COMMAND_LENGTH = sizeof(HISTORY_COMMAND) - 1;
+const uint8_t HISTORY_READER_MAX_CHARS = 16; // bounds the time spent per frame
+const uint8_t HISTORY_LINE_MISMATCH = 0xFF;
+
+uint8_t historyCommandMatched = 0; // characters of HISTORY_COMMAND seen on this line
+bool historyDumping = false;
+
+// Called once per loop()
+void pollHistoryReader() {
+  if (historyDumping) {
+    if (Serial.availableForWrite() >= SERIAL_DUMP_LINE_MAX) {
+      historyDumping = dumpHistoryLine();
+    }
+    return;
+  }
+
+  for (uint8_t n = 0; n < HISTORY_READER_MAX_CHARS && Serial.available() > 0; n++) {
+    char c = Serial.read();
+    if (c == '\r') continue;
+    if (c == '\n') {
+      historyDumping = historyCommandMatched == HISTORY_COMMAND_LENGTH;
+      historyCommandMatched = 0;
+      if (historyDumping) {
+        beginHistoryDump();
+        return;
+      }
+    } else if (historyCommandMatched < HISTORY_COMMAND_LENGTH &&
+               c == (char)pgm_read_byte(&HISTORY_COMMAND[historyCommandMatched])) {
+      historyCommandMatched++;
+    } else {
+      historyCommandMatched = HISTORY_LINE_MISMATCH;
+    }
+  }
+}
+#endif // !SERIAL_CONSOLE
+
+#endif // SERIAL_CONSOLE || HISTORY_SERIAL
+
+#endif // HISTORY_LOG_H
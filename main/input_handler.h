@@ -2,199 +2,312 @@
 #define INPUT_HANDLER_H
 
 #include "config.h"
+#include "auto_repeat.h"
+#include "focus_ring.h"
+#include "gesture.h"
 #include "game_logic.h"
+#include "game_state.h"
 #include "save_system.h"
 #include "ui_screens.h"
 
-void handleJoystick() {
-  unsigned long now = millis();
-  if (now - lastJoystickMoveTime < JOYSTICK_DELAY) {
-    return;
-  }
-  
-  // Read joystick state once
-  bool rightPressed = digitalRead(JOY_RIGHT) == HIGH;
-  bool leftPressed = digitalRead(JOY_LEFT) == HIGH;
-  bool upPressed = digitalRead(JOY_UP) == HIGH;
-  bool downPressed = digitalRead(JOY_DOWN) == HIGH;
-  
+// Sample all joystick pins at once, plus any injected presses
+uint8_t readJoystickButtons() {
+  uint8_t buttons = injectedButtons;
+#if LCD_BUDGET_CHECK
+  return buttons; // the scenarios must not see a real joystick
+#else
+  if (digitalRead(JOY_CENTER) == HIGH) buttons |= JOY_MASK_CENTER;
+  if (digitalRead(JOY_UP) == HIGH) buttons |= JOY_MASK_UP;
+  if (digitalRead(JOY_DOWN) == HIGH) buttons |= JOY_MASK_DOWN;
+  if (digitalRead(JOY_LEFT) == HIGH) buttons |= JOY_MASK_LEFT;
+  if (digitalRead(JOY_RIGHT) == HIGH) buttons |= JOY_MASK_RIGHT;
+  return buttons;
+#endif
+}
+
+void handleJoystick(uint8_t buttons) {
+  static AutoRepeat repeat(JOYSTICK_REPEAT);
+  static uint8_t lastDirection = 0;
+
   // Only move if exactly one direction is pressed
-  if (rightPressed && !leftPressed && !upPressed && !downPressed && cursorX < 15) {
-    cursorX++;
-    lastJoystickMoveTime = now;
-  } else if (leftPressed && !rightPressed && !upPressed && !downPressed && cursorX > 0) {
-    cursorX--;
-    lastJoystickMoveTime = now;
-  } else if (upPressed && !rightPressed && !leftPressed && !downPressed && cursorY > 0) {
-    cursorY--;
-    lastJoystickMoveTime = now;
-  } else if (downPressed && !rightPressed && !leftPressed && !upPressed && cursorY < 1) {
-    cursorY++;
-    lastJoystickMoveTime = now;
+  uint8_t direction = buttons & (JOY_MASK_UP | JOY_MASK_DOWN | JOY_MASK_LEFT | JOY_MASK_RIGHT);
+  if (direction & (direction - 1)) {
+    direction = 0;
+  }
+  // A different direction starts a new hold with its own initial delay
+  if (direction != 0 && direction != lastDirection) {
+    repeat.release();
+    lastDirection = direction;
+  }
+
+  for (uint8_t steps = repeat.update(direction != 0, nowMs()); steps > 0; steps--) {
+#if FOCUS_NAVIGATION
+    if (moveFocus(lastDirection)) continue;
+#endif
+    if (lastDirection == JOY_MASK_RIGHT && cursorX < Panel::LAST_X) {
+      cursorX++;
+    } else if (lastDirection == JOY_MASK_LEFT && cursorX > 0) {
+      cursorX--;
+    } else if (lastDirection == JOY_MASK_UP && cursorY > 0) {
+      cursorY--;
+    } else if (lastDirection == JOY_MASK_DOWN && cursorY < Panel::LAST_Y) {
+      cursorY++;
+    }
   }
 }
 
-void handleButtonPress() {
-  static bool lastState = false;
-  static unsigned long lastAutoCraftTime = 0;
-  bool pressed = digitalRead(JOY_CENTER);
-  unsigned long now = millis();
+// One purchase in each shop; false if it can't be afforded (or is maxed out)
+bool buyClickUpgrade() {
+  if (!spendCookies(calculateUpgradeCost())) return false;
+  setCookiesPerClick(getNextClickPower(game.cookiesPerClick));
+  addUpgrade();
+  return true;
+}
+
+bool buyAutoClickUpgrade() {
+  if (!spendCookies(calculateAutoClickUpgradeCost())) return false;
+  setAutoClickLevel(game.autoClickLevel + 1);
+  return true;
+}
+
+bool buyGenerator() {
+  uint8_t level = game.generatorLevels[generatorShopIndex];
+  if (isGeneratorMaxed(generatorShopIndex) || !spendCookies(calculateGeneratorCost(generatorShopIndex))) return false;
+  setGeneratorLevel(generatorShopIndex, level + 1);
+  return true;
+}
+
+typedef bool (*ShopPurchase)();
+
+// The purchase behind the buy button of the shop on screen, or nullptr
+ShopPurchase currentShopPurchase() {
+  switch (currentScreen) {
+    case SHOP: return buyClickUpgrade;
+    case AUTOCLICK_SHOP: return buyAutoClickUpgrade;
+    case GENERATOR_SHOP: return buyGenerator;
+    default: return nullptr;
+  }
+}
+
+// Double tap is bound only on a shop's buy button, so taps anywhere else fire
+// as soon as the button is released
+bool doubleTapBound() {
+  return currentShopPurchase() != nullptr && cursorY == 0 && cursorX == BUTTON_UPGRADE_X;
+}
+
+void buyOne(ShopPurchase buy) {
+  if (buy()) {
+    showMessage("BOUGHT", "", currentScreen, 2000);
+  }
+}
+
+// Buy as many as the cookies allow, up to BUY_MAX_LIMIT
+void buyMax(ShopPurchase buy) {
+  uint8_t bought = 0;
+  while (bought < BUY_MAX_LIMIT && buy()) {
+    bought++;
+  }
+  if (bought > 0) {
+    char text[8];
+    snprintf(text, sizeof(text), "x%u", bought);
+    showMessage("BOUGHT", text, currentScreen, 2000);
+  }
+}
+
+// Long press: STATS from MAIN, a quick save anywhere else
+void handleLongPress() {
+  if (currentScreen == MAIN) {
+    currentScreen = STATS;
+    cursorX = 0;
+    cursorY = 1;
+  } else {
+    manualSave();
+    showMessage("SAVED", "", currentScreen, 1000);
+  }
+}
+
+void handleCenterTap() {
+  switch (currentScreen) {
+    case MAIN:
+      // Gift press handling
+      if (game.giftActive && cursorY == 0 && cursorX == game.giftPos) {
+        activateGift();
+        return;
+      }
+      // SHOP button
+      else if (cursorY == BUTTON_MENU_Y && cursorX >= BUTTON_SHOP_X_START && cursorX <= BUTTON_SHOP_X_END) {
+        currentScreen = SHOP;
+      }
+      // 'a' button (autoclick shop)
+      else if (cursorY == BUTTON_MENU_Y && cursorX == BUTTON_AUTOCLICK_X) {
+        currentScreen = AUTOCLICK_SHOP;
+        cursorX = 0;
+        cursorY = 1;
+      }
+      // 'g' button (generator shop)
+      else if (cursorY == BUTTON_MENU_Y && cursorX == BUTTON_GENERATOR_X) {
+        currentScreen = GENERATOR_SHOP;
+        cursorX = BUTTON_UPGRADE_X;
+        cursorY = 0;
+      }
+      // '*' button (prestige)
+      else if (cursorY == BUTTON_MENU_Y && cursorX == BUTTON_PRESTIGE_X) {
+          if (game.cookies >= 1000000) {
+              currentScreen = PRESTIGE_CONFIRM;
+              cursorX = 0;
+              cursorY = 1;
+          } else {
+              showMessage("YOU HAVEN'T ENOUGH COOKIES", "Prestige needs 1000000 and restarts", MAIN, 5000);
+          }
+      }
+      // Кнопка S - статистика (после количества печенек)
+      else if (cursorY == 0 && cursorX == getStatsButtonX()) {
+        currentScreen = STATS;
+        cursorX = 0;
+        cursorY = 1;
+      }
+      // Any other click is a regular cookie click
+      else {
+        recordClick(getClickValue());
+      }
+      break;
+    
+    case PRESTIGE_CONFIRM:
+      // NO button
+      if (cursorY == 1 && cursorX >= BUTTON_PRESTIGE_NO_X_START && cursorX <= BUTTON_PRESTIGE_NO_X_END) {
+          currentScreen = MAIN;
+      }
+      // YES button
+      else if (cursorY == 1 && cursorX >= BUTTON_PRESTIGE_YES_X_START && cursorX <= BUTTON_PRESTIGE_YES_X_END) {
+          activatePrestige();
+      }
+      break;
+
+
+
+    case AUTOCLICK_SHOP:
+      // Exit button is now on the second line
+      if (cursorY == 1 && cursorX == BUTTON_BACK_X) {
+        currentScreen = MAIN;
+      }
+      // Upgrade button is at (0,0)
+      else if (cursorY == 0 && cursorX == BUTTON_UPGRADE_X) {
+        buyOne(buyAutoClickUpgrade);
+      }
+      break;
+
+    case SHOP:
+      // Back button
+      if (cursorY == 1 && cursorX == BUTTON_BACK_X) {
+        currentScreen = MAIN;
+      }
+      // Upgrade button
+      else if (cursorY == 0 && cursorX == BUTTON_UPGRADE_X) {
+        buyOne(buyClickUpgrade);
+      }
+      break;
+
+    case GENERATOR_SHOP:
+      // Back button
+      if (cursorY == 1 && cursorX == BUTTON_BACK_X) {
+        currentScreen = MAIN;
+      }
+      // Buy one more of the building on screen
+      else if (cursorY == 0 && cursorX == BUTTON_UPGRADE_X) {
+        buyOne(buyGenerator);
+      }
+      // > shows the next building
+      else if (cursorY == 1 && cursorX == BUTTON_NEXT_GENERATOR_X) {
+        generatorShopIndex = (generatorShopIndex + 1) % GENERATOR_COUNT;
+        requestFullRedraw();
+      }
+      break;
+
+    case STATS:
+      // Exit button <
+      if (cursorY == 1 && cursorX == BUTTON_BACK_X) {
+        currentScreen = MAIN;
+      }
+      // Save button S (moved to top right)
+      // This is now handled above
+      // Reset button R
+      else if (cursorY == 1 && cursorX == BUTTON_RESET_X) {
+        manualReset();
+      }
+      // Save button S (top right)
+      else if (cursorY == 0 && cursorX == BUTTON_SAVE_X) {
+        manualSave();
+      }
+      // Rates button >
+      else if (cursorY == 0 && cursorX == BUTTON_RATES_X) {
+        currentScreen = RATES;
+        cursorX = BUTTON_RATE_WINDOW_X;
+        cursorY = 0;
+      }
+      break;
+
+    case RATES:
+      // Back to STATS
+      if (cursorY == 0 && cursorX == BUTTON_BACK_X) {
+        currentScreen = STATS;
+        cursorX = BUTTON_RATES_X;
+        cursorY = 0;
+      }
+      // > cycles 10 s / 1 min / 10 min
+      else if (cursorY == 0 && cursorX == BUTTON_RATE_WINDOW_X) {
+        rateWindow = (rateWindow + 1) % RATE_WINDOW_COUNT;
+        markDirty(DIRTY_RATES);
+      }
+      break;
+  }
+}
+
+void handleButtonPress(uint8_t buttons) {
+  static AutoRepeat farmRepeat(FARM_REPEAT);
+  static Gesture center(CENTER_GESTURE);
+  bool pressed = buttons & JOY_MASK_CENTER;
+  unsigned long now = nowMs();
   
   // This block handles HELD presses, specifically for autocrafting на главном экране.
   // Теперь работает и для верхней, и для нижней строки с J.
-  if (currentScreen == MAIN && !congratsActive && pressed && cursorX >= BUTTON_FARM_X_START && cursorX <= BUTTON_FARM_X_END && (cursorY == 0 || cursorY == 1)) {
-    if (now - lastAutoCraftTime > DEBOUNCE_DELAY) {
-      int clickValue = bonus573Active ? (cookiesPerClick + 573) : cookiesPerClick;
-      cookies += clickValue;
-      totalCookies += clickValue;
-      totalClicks++;
-      lastAutoCraftTime = now;
-      needRedraw = true;
-    }
+  // Clicks speed up the longer the button is held (FARM_REPEAT)
+  bool onFarm = currentScreen == MAIN && !game.congratsActive && isFarmCell(cursorX, cursorY);
+  for (uint8_t clicks = farmRepeat.update(onFarm && pressed, now); clicks > 0; clicks--) {
+    recordClick(getClickValue());
+  }
+
+  // Everywhere else the button speaks in gestures (CENTER_GESTURE). A tap held
+  // back for a double tap buys where it was made, even if the cursor has moved
+  // on by the time it fires.
+  static ShopPurchase heldPurchase = nullptr;
+  bool waiting = center.tapPending();
+  GestureEvent event = center.update(pressed && !onFarm, now, doubleTapBound());
+  if (!waiting && center.tapPending()) {
+    heldPurchase = currentShopPurchase();
+  }
+  if (event == GESTURE_NONE || event == GESTURE_HOLD_RELEASE) {
     return;
   }
-  
-  // This block handles SINGLE presses, with debouncing.
-  if (pressed && !lastState && now - lastButtonPressTime > DEBOUNCE_DELAY) {
-    lastButtonPressTime = now;
-    
-    // Handle message screen - any press closes it (before congrats check)
-    if (currentScreen == MESSAGE_SCREEN) {
-        currentScreen = screenAfterMessage;
-        messageTimeout = 0;
-        needRedraw = true;
-        lastState = pressed;
-        return;
-    }
-    
-    if (congratsActive) {
-        lastState = pressed;
-        return;
-    }
 
-    switch (currentScreen) {
-      case MAIN:
-        // Gift press handling
-        if (giftActive && cursorY == 0 && cursorX == giftPos) {
-          activateGift();
-          needRedraw = true;
-          lastState = pressed;
-          return;
-        }
-        // SHOP button
-        else if (cursorY == 1 && cursorX >= BUTTON_SHOP_X_START && cursorX <= BUTTON_SHOP_X_END) {
-          currentScreen = SHOP;
-          needRedraw = true;
-        }
-        // 'a' button (autoclick shop)
-        else if (cursorY == 1 && cursorX == BUTTON_AUTOCLICK_X) {
-          currentScreen = AUTOCLICK_SHOP;
-          cursorX = 0;
-          cursorY = 1;
-          needRedraw = true;
-        }
-        // '*' button (prestige)
-        else if (cursorY == 1 && cursorX == BUTTON_PRESTIGE_X) {
-            if (cookies >= 1000000) {
-                currentScreen = PRESTIGE_CONFIRM;
-                cursorX = 0;
-                cursorY = 1;
-            } else {
-                showMessage("YOU HAVEN'T", "ENOUGH COOKIES", MAIN, 5000);
-            }
-            needRedraw = true;
-        }
-        // Кнопка S - статистика (после количества печенек)
-        else if (cursorY == 0 && cursorX == getDigitCount(cookies)) {
-          currentScreen = STATS;
-          cursorX = 0;
-          cursorY = 1;
-          needRedraw = true;
-        }
-        // Any other click is a regular cookie click
-        else {
-          int clickValue = bonus573Active ? (cookiesPerClick + 573) : cookiesPerClick;
-          cookies += clickValue;
-          totalCookies += clickValue;
-          totalClicks++;
-          needRedraw = true;
-        }
-        break;
-      
-      case PRESTIGE_CONFIRM:
-        // NO button
-        if (cursorY == 1 && cursorX >= BUTTON_PRESTIGE_NO_X_START && cursorX <= BUTTON_PRESTIGE_NO_X_END) {
-            currentScreen = MAIN;
-            needRedraw = true;
-        }
-        // YES button
-        else if (cursorY == 1 && cursorX >= BUTTON_PRESTIGE_YES_X_START && cursorX <= BUTTON_PRESTIGE_YES_X_END) {
-            activatePrestige();
-            needRedraw = true;
-        }
-        break;
-
-
-
-      case AUTOCLICK_SHOP:
-        // Exit button is now on the second line
-        if (cursorY == 1 && cursorX == BUTTON_BACK_X) {
-          currentScreen = MAIN;
-          needRedraw = true;
-        }
-        // Upgrade button is at (0,0)
-        else if (cursorY == 0 && cursorX == BUTTON_UPGRADE_X) {
-          long long cost = calculateAutoClickUpgradeCost();
-          if (cookies >= cost) {
-            cookies -= cost;
-            autoClickLevel++;
-            showMessage("BOUGHT", "", AUTOCLICK_SHOP, 2000);
-            needRedraw = true;
-          }
-        }
-        break;
+  // Handle message screen - any press closes it (before congrats check)
+  if (currentScreen == MESSAGE_SCREEN) {
+    currentScreen = screenAfterMessage;
+    messageTimeout = 0;
+    return;
+  }
 
-      case SHOP:
-        // Back button
-        if (cursorY == 1 && cursorX == BUTTON_BACK_X) {
-          currentScreen = MAIN;
-          needRedraw = true;
-        }
-        // Upgrade button
-        else if (cursorY == 0 && cursorX == BUTTON_UPGRADE_X) {
-          long long cost = calculateUpgradeCost();
-          if (cookies >= cost) {
-            cookies -= cost;
-            cookiesPerClick = getNextClickPower(cookiesPerClick);
-            totalUpgrades++;
-            showMessage("BOUGHT", "", SHOP, 2000);
-            needRedraw = true;
-          }
-        }
-        break;
+  if (game.congratsActive) {
+    return;
+  }
 
-      case STATS:
-        // Exit button <
-        if (cursorY == 1 && cursorX == BUTTON_BACK_X) {
-          currentScreen = MAIN;
-          needRedraw = true;
-        }
-        // Save button S (moved to top right)
-        // This is now handled above
-        // Reset button R
-        else if (cursorY == 1 && cursorX == BUTTON_RESET_X) {
-          manualReset();
-          needRedraw = true;
-        }
-        // Save button S (top right)
-        else if (cursorY == 0 && cursorX == 15) {
-          manualSave();
-          needRedraw = true;
-        }
-        break;
-    }
-    
-    lastState = pressed;
+  if (event == GESTURE_LONG_PRESS) {
+    handleLongPress();
+  } else if (event == GESTURE_DOUBLE_TAP) {
+    buyMax(heldPurchase);
+  } else if (waiting) {
+    buyOne(heldPurchase);
+  } else {
+    handleCenterTap();
   }
 }
 
@@ -0,0 +1,326 @@
+#ifndef LCD_BACKEND_H
+#define LCD_BACKEND_H
+
+// --- DISPLAY BACKENDS ---
+// Everything the sketch does with the panel goes through `lcd`, whose type is
+// picked here at compile time. Backends share print() through a CRTP base, so
+// there are no virtual calls, and each build only compiles its own backend.
+// Included from config.h, after the pins and the panel geometry.
+
+#define LCD_BACKEND_PARALLEL 0  // HD44780 on 6 pins (LiquidCrystal)
+#define LCD_BACKEND_I2C 1       // HD44780 behind a PCF8574 I2C backpack
+#define LCD_BACKEND_RECORDING 2 // no hardware: counters + shadow display, for host runs
+
+#ifndef LCD_BACKEND
+#define LCD_BACKEND LCD_BACKEND_PARALLEL
+#endif
+
+// Counters for everything the sketch sends to the HD44780
+struct LcdTraffic {
+  unsigned long bytes;      // command + data bytes for the controller
+  unsigned long setCursors;
+  unsigned long clears;
+  unsigned long busBytes;   // bytes actually on the wire, protocol overhead included
+};
+
+// HD44780 instruction set (the parts the backends use directly)
+const uint8_t HD44780_CLEAR = 0x01;
+const uint8_t HD44780_HOME = 0x02;
+const uint8_t HD44780_ENTRY_LEFT = 0x06;
+const uint8_t HD44780_SHIFT_LEFT = 0x18;  // display shift: whole window one column left
+const uint8_t HD44780_DISPLAY_ON = 0x0C;
+const uint8_t HD44780_FUNCTION_4BIT_1LINE = 0x20;
+const uint8_t HD44780_FUNCTION_4BIT_2LINE = 0x28;
+const uint8_t HD44780_SET_CGRAM = 0x40;
+const uint8_t HD44780_SET_DDRAM = 0x80;
+const uint8_t HD44780_DDRAM_ROW = 40;     // columns per row in 2-line mode
+
+// Shared front end: print() overloads and traffic counters
+template <class Backend>
+class LcdBackend {
+public:
+  LcdTraffic traffic = {0, 0, 0, 0};
+
+  void print(const char* str) {
+    while (*str) {
+      self().write((uint8_t)*str++);
+    }
+  }
+
+  void print(const __FlashStringHelper* str) {
+    PGM_P p = reinterpret_cast<PGM_P>(str);
+    uint8_t c;
+    while ((c = pgm_read_byte(p++)) != 0) {
+      self().write(c);
+    }
+  }
+
+  void print(long value) {
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%ld", value);
+    print(buf);
+  }
+
+  void resetTraffic() {
+    traffic = LcdTraffic{0, 0, 0, 0};
+  }
+
+protected:
+  // DDRAM address of a cell, same row layout as LiquidCrystal
+  static uint8_t ddramAddress(uint8_t col, uint8_t row) {
+    const uint8_t rowOffsets[4] = {0x00, 0x40, (uint8_t)(0x00 + LCD_WIDTH), (uint8_t)(0x40 + LCD_WIDTH)};
+    return col + rowOffsets[row & 3];
+  }
+
+private:
+  Backend& self() {
+    return static_cast<Backend&>(*this);
+  }
+};
+
+#if LCD_BACKEND == LCD_BACKEND_PARALLEL
+
+#include <LiquidCrystal.h>
+
+// 4-bit parallel bus; each controller byte goes out as two nibble strobes
+class ParallelLcd : public LcdBackend<ParallelLcd> {
+public:
+  ParallelLcd() : lcd_(PIN_RS, PIN_EN, PIN_DB4, PIN_DB5, PIN_DB6, PIN_DB7) {}
+
+  void begin(uint8_t cols, uint8_t rows) {
+    lcd_.begin(cols, rows);
+  }
+
+  void clear() {
+    traffic.clears++;
+    count(1);
+    lcd_.clear();
+  }
+
+  void home() {
+    count(1);
+    lcd_.home();
+  }
+
+  void setCursor(uint8_t col, uint8_t row) {
+    traffic.setCursors++;
+    count(1);
+    lcd_.setCursor(col, row);
+  }
+
+  void command(uint8_t value) {
+    count(1);
+    lcd_.command(value);
+  }
+
+  void createChar(uint8_t location, uint8_t charmap[]) {
+    count(9); // CGRAM address + 8 rows
+    lcd_.createChar(location, charmap);
+  }
+
+  void write(uint8_t value) {
+    count(1);
+    lcd_.write(value);
+  }
+
+  // Nothing is buffered on the parallel bus
+  void flush() {}
+
+private:
+  void count(uint8_t n) {
+    traffic.bytes += n;
+    traffic.busBytes += n;
+  }
+
+  LiquidCrystal lcd_;
+};
+
+typedef ParallelLcd LcdDevice;
+
+#elif LCD_BACKEND == LCD_BACKEND_I2C
+
+#include <Wire.h>
+
+#ifndef LCD_I2C_ADDRESS
+#define LCD_I2C_ADDRESS 0x27
+#endif
+// 100 kHz works with any backpack and cable length; -DLCD_I2C_CLOCK=400000 for
+// short wires and a PCF8574A or a 400 kHz-rated part
+#ifndef LCD_I2C_CLOCK
+#define LCD_I2C_CLOCK 100000
+#endif
+
+// PCF8574 backpack wiring used by most modules: P0=RS P1=RW P2=EN P3=backlight P4..P7=D4..D7
+const uint8_t PCF8574_RS = 0x01;
+const uint8_t PCF8574_EN = 0x04;
+const uint8_t PCF8574_BACKLIGHT = 0x08;
+
+// Every nibble costs two expander writes (EN high, EN low), i.e. four bus bytes
+// per controller byte. Instead of one I2C transaction per nibble, writes are
+// queued and sent as one transaction per Wire buffer, flushed at the end of each
+// frame or before a slow command. At <= 400 kHz the expander writes themselves
+// are slower than the controller's 37 us instruction time, so no extra delays
+// are needed inside a batch.
+class I2cLcd : public LcdBackend<I2cLcd> {
+public:
+  void begin(uint8_t cols, uint8_t rows) {
+    Wire.begin();
+    Wire.setClock(LCD_I2C_CLOCK);
+    delay(50); // power-on settle time
+
+    // Software reset into 4-bit mode (HD44780 datasheet, figure 24)
+    sendNibbleNow(0x30, 4500);
+    sendNibbleNow(0x30, 4500);
+    sendNibbleNow(0x30, 150);
+    sendNibbleNow(0x20, 150);
+
+    command(rows > 1 ? HD44780_FUNCTION_4BIT_2LINE : HD44780_FUNCTION_4BIT_1LINE);
+    command(HD44780_DISPLAY_ON);
+    clear();
+    command(HD44780_ENTRY_LEFT);
+    flush();
+    (void)cols;
+  }
+
+  void clear() {
+    traffic.clears++;
+    command(HD44780_CLEAR);
+    flush();
+    delayMicroseconds(2000);
+  }
+
+  void home() {
+    command(HD44780_HOME);
+    flush();
+    delayMicroseconds(2000);
+  }
+
+  void setCursor(uint8_t col, uint8_t row) {
+    traffic.setCursors++;
+    command(HD44780_SET_DDRAM | ddramAddress(col, row));
+  }
+
+  void command(uint8_t value) {
+    queueByte(value, 0);
+  }
+
+  void createChar(uint8_t location, uint8_t charmap[]) {
+    command(HD44780_SET_CGRAM | ((location & 7) << 3));
+    for (uint8_t i = 0; i < 8; i++) {
+      write(charmap[i]);
+    }
+  }
+
+  void write(uint8_t value) {
+    queueByte(value, PCF8574_RS);
+  }
+
+  // Send everything queued as a single I2C transaction
+  void flush() {
+    if (txLength_ == 0) return;
+    Wire.beginTransmission(LCD_I2C_ADDRESS);
+    Wire.write(tx_, txLength_);
+    Wire.endTransmission();
+    traffic.busBytes += txLength_ + 1; // payload + address byte
+    txLength_ = 0;
+  }
+
+private:
+  void queueByte(uint8_t value, uint8_t mode) {
+    traffic.bytes++;
+    queueNibble(value & 0xF0, mode);
+    queueNibble((value << 4) & 0xF0, mode);
+  }
+
+  void queueNibble(uint8_t nibble, uint8_t mode) {
+    if ((size_t)txLength_ + 2 > sizeof(tx_)) flush();
+    uint8_t out = nibble | mode | PCF8574_BACKLIGHT;
+    tx_[txLength_++] = out | PCF8574_EN; // latched on the falling edge of EN
+    tx_[txLength_++] = out;
+  }
+
+  // Reset sequence nibbles need their own timing
+  void sendNibbleNow(uint8_t nibble, unsigned int settleUs) {
+    queueNibble(nibble, 0);
+    flush();
+    delayMicroseconds(settleUs);
+  }
+
+  uint8_t tx_[BUFFER_LENGTH]; // Wire's transmit buffer size
+  uint8_t txLength_ = 0;
+};
+
+typedef I2cLcd LcdDevice;
+
+#elif LCD_BACKEND == LCD_BACKEND_RECORDING
+
+// No hardware: counts traffic and keeps a shadow of what the panel would show
+class RecordingLcd : public LcdBackend<RecordingLcd> {
+public:
+  char screen[LCD_HEIGHT][LCD_WIDTH];
+
+  void begin(uint8_t cols, uint8_t rows) {
+    (void)cols;
+    (void)rows;
+    clear();
+  }
+
+  void clear() {
+    traffic.clears++;
+    count(1);
+    memset(screen, ' ', sizeof(screen));
+    col_ = 0;
+    row_ = 0;
+  }
+
+  void home() {
+    count(1);
+    col_ = 0;
+    row_ = 0;
+  }
+
+  void setCursor(uint8_t col, uint8_t row) {
+    traffic.setCursors++;
+    count(1);
+    col_ = col;
+    row_ = row;
+  }
+
+  void command(uint8_t value) {
+    (void)value;
+    count(1);
+  }
+
+  void createChar(uint8_t location, uint8_t charmap[]) {
+    (void)location;
+    (void)charmap;
+    count(9);
+  }
+
+  void write(uint8_t value) {
+    count(1);
+    if (row_ < LCD_HEIGHT && col_ < LCD_WIDTH) {
+      screen[row_][col_] = value;
+    }
+    col_++;
+  }
+
+  void flush() {}
+
+private:
+  void count(uint8_t n) {
+    traffic.bytes += n;
+    traffic.busBytes += n;
+  }
+
+  uint8_t col_ = 0;
+  uint8_t row_ = 0;
+};
+
+typedef RecordingLcd LcdDevice;
+
+#else
+#error "Unknown LCD_BACKEND"
+#endif
+
+#endif // LCD_BACKEND_H
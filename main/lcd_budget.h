@@ -0,0 +1,240 @@
+#ifndef LCD_BUDGET_H
+#define LCD_BUDGET_H
+
+#include "config.h"
+#include "save_system.h"
+#include "ui_screens.h"
+#include "achievements.h"
+
+#if LCD_BUDGET_CHECK
+
+// --- LCD BUS-TRAFFIC BUDGET SUITE ---
+// Drives the sketch through scripted scenarios with the real loop() running,
+// counts everything sent to the LCD and compares the per-second rates with the
+// budgets below. Results go to Serial; a change that blows a budget prints FAIL.
+// The scripts buy, reset and prestige, so saves and history stay in RAM
+// (RAM_STORAGE) and the unit's own progress survives the suite.
+
+// One step of a scenario script: hold these buttons for this long
+struct LcdScriptStep {
+  uint8_t buttons;
+  unsigned int durationMs;
+};
+
+// A scripted scenario and its checked-in per-second budget
+struct LcdScenario {
+  const char* name;
+  void (*prepare)();
+  const LcdScriptStep* steps;
+  uint8_t stepCount;
+  unsigned int maxBytesPerSec;
+  unsigned int maxSetCursorsPerSec;
+  unsigned int maxClearsPerSec;
+};
+
+// Put the game on a screen with no timers about to fire
+void lcdScenarioEnter(GameState screen, int x, int y) {
+  currentScreen = screen;
+  cursorX = x;
+  cursorY = y;
+  clearGift();
+  setCongrats(false);
+  setBonus573(false);
+  messageTimeout = 0;
+  lastGiftTime = nowMs();
+  nextMilestone = -1; // a milestone message would hijack the script
+}
+
+void prepareIdleMain() {
+  lcdScenarioEnter(MAIN, BUTTON_PRESTIGE_X + 2, BUTTON_MENU_Y);
+}
+
+void prepareFarming() {
+  lcdScenarioEnter(MAIN, BUTTON_FARM_X_START, 0);
+}
+
+void prepareGift() {
+  lcdScenarioEnter(MAIN, Panel::GIFT_X_START, 0);
+  spawnGift(0, Panel::GIFT_X_START);
+}
+
+void prepareShop() {
+  lcdScenarioEnter(SHOP, BUTTON_UPGRADE_X, 0);
+  setCookies(1000000);
+}
+
+void prepareStats() {
+  lcdScenarioEnter(STATS, BUTTON_BACK_X, 1);
+}
+
+void prepareRates() {
+  lcdScenarioEnter(RATES, BUTTON_RATE_WINDOW_X, 0);
+  rateWindow = 0;
+}
+
+// A message wider than the panel, left up until the scenario ends
+void prepareTicker() {
+  lcdScenarioEnter(MAIN, 0, 0);
+  showMessage("YOU HAVEN'T ENOUGH COOKIES", "Prestige needs 1000000 and restarts", MAIN, 0);
+}
+
+void preparePrestige() {
+  lcdScenarioEnter(MAIN, BUTTON_PRESTIGE_X, BUTTON_MENU_Y);
+  setCookies(1000000);
+}
+
+const LcdScriptStep IDLE_STEPS[] = {
+  {0, 5000}
+};
+
+const LcdScriptStep FARMING_STEPS[] = {
+  {JOY_MASK_CENTER, 5000}
+};
+
+// Pick the gift, then sit through the whole congrats screen
+const LcdScriptStep GIFT_STEPS[] = {
+  {JOY_MASK_CENTER, 100},
+  {0, CONGRATS_TIME + 500}
+};
+
+// Buy, dismiss "BOUGHT", buy again...
+const LcdScriptStep SHOP_STEPS[] = {
+  {JOY_MASK_CENTER, 100}, {0, 600},
+  {JOY_MASK_CENTER, 100}, {0, 600},
+  {JOY_MASK_CENTER, 100}, {0, 600},
+  {JOY_MASK_CENTER, 100}, {0, 600}
+};
+
+// Walk from '<' towards 'R' and back
+const LcdScriptStep STATS_STEPS[] = {
+  {0, 1000},
+  {JOY_MASK_RIGHT, 1000},
+  {0, 1000},
+  {JOY_MASK_LEFT, 1000},
+  {0, 1000}
+};
+
+// Rates tick once a second; '>' cycles through the windows
+const LcdScriptStep RATES_STEPS[] = {
+  {0, 2000},
+  {JOY_MASK_CENTER, 100}, {0, 900},
+  {JOY_MASK_CENTER, 100}, {0, 900},
+  {JOY_MASK_CENTER, 100}, {0, 900}
+};
+
+const LcdScriptStep TICKER_STEPS[] = {
+  {0, 6000}
+};
+
+// '*' on MAIN, step onto YES, confirm
+const LcdScriptStep PRESTIGE_STEPS[] = {
+  {JOY_MASK_CENTER, 100}, {0, 600},
+  {JOY_MASK_RIGHT, 100}, {0, 600},
+  {JOY_MASK_CENTER, 100}, {0, 2000}
+};
+
+const unsigned long LCD_SCENARIO_GAP_MS = 50;
+
+#define LCD_STEPS(steps) steps, sizeof(steps) / sizeof(steps[0])
+
+// Budgets: bytes/s, setCursor/s, clear/s.
+// Frames only touch the panel for dirty fields and the blinking cursor, so the
+// budgets sit at roughly twice the measured traffic.
+const LcdScenario LCD_SCENARIOS[] = {
+  {"idle-main", prepareIdleMain, LCD_STEPS(IDLE_STEPS), 24, 10, 0},
+  {"farming", prepareFarming, LCD_STEPS(FARMING_STEPS), 110, 24, 0}, // one counter redraw per repeat
+  {"gift", prepareGift, LCD_STEPS(GIFT_STEPS), 40, 12, 1},
+  {"shop", prepareShop, LCD_STEPS(SHOP_STEPS), 120, 16, 3},
+  {"stats", prepareStats, LCD_STEPS(STATS_STEPS), 40, 12, 1},
+  {"rates", prepareRates, LCD_STEPS(RATES_STEPS), 140, 16, 1},
+  {"ticker", prepareTicker, LCD_STEPS(TICKER_STEPS), 40, 4, 1}, // one shift byte per step
+  {"prestige", preparePrestige, LCD_STEPS(PRESTIGE_STEPS), 50, 16, 2}
+};
+const uint8_t LCD_SCENARIO_COUNT = sizeof(LCD_SCENARIOS) / sizeof(LCD_SCENARIOS[0]);
+
+void printLcdRate(const __FlashStringHelper* label, unsigned long rate, unsigned int budget) {
+  Serial.print(label);
+  Serial.print(rate);
+  Serial.print('/');
+  Serial.print(budget);
+}
+
+// Print one scenario line, return true if it stayed within budget
+bool reportLcdScenario(const LcdScenario& scenario, unsigned long elapsedMs) {
+  if (elapsedMs == 0) elapsedMs = 1;
+  unsigned long bytesPerSec = lcd.traffic.bytes * 1000UL / elapsedMs;
+  unsigned long setCursorsPerSec = lcd.traffic.setCursors * 1000UL / elapsedMs;
+  unsigned long clearsPerSec = (lcd.traffic.clears * 1000UL + elapsedMs - 1) / elapsedMs; // round up
+  bool pass = bytesPerSec <= scenario.maxBytesPerSec &&
+              setCursorsPerSec <= scenario.maxSetCursorsPerSec &&
+              clearsPerSec <= scenario.maxClearsPerSec;
+
+  Serial.print(F("LCD "));
+  Serial.print(scenario.name);
+  printLcdRate(F(" bytes/s="), bytesPerSec, scenario.maxBytesPerSec);
+  printLcdRate(F(" setCursor/s="), setCursorsPerSec, scenario.maxSetCursorsPerSec);
+  printLcdRate(F(" clear/s="), clearsPerSec, scenario.maxClearsPerSec);
+  Serial.println(pass ? F(" PASS") : F(" FAIL"));
+  return pass;
+}
+
+// Called at the top of loop(); advances the script and reports finished scenarios
+void lcdBudgetTick() {
+  static uint8_t scenarioIndex = 0;
+  static uint8_t stepIndex = 0;
+  static unsigned long scenarioStart = 0;
+  static unsigned long stepStart = 0;
+  static bool running = false;
+  static uint8_t failures = 0;
+
+  if (scenarioIndex >= LCD_SCENARIO_COUNT) {
+    return;
+  }
+  pendingAchievement = -1; // an announcement would hijack the script
+  const LcdScenario& scenario = LCD_SCENARIOS[scenarioIndex];
+  unsigned long now = nowMs();
+
+  if (!running) {
+    // Buttons stay released between scenarios for longer than the input
+    // sampling period and the auto-repeat bounce bridge
+    if (now - stepStart < LCD_SCENARIO_GAP_MS) {
+      return;
+    }
+    scenario.prepare();
+    stepIndex = 0;
+    scenarioStart = now;
+    stepStart = now;
+    injectedButtons = scenario.steps[0].buttons;
+    lcd.resetTraffic();
+    running = true;
+    return;
+  }
+
+  if (now - stepStart < scenario.steps[stepIndex].durationMs) {
+    return;
+  }
+  stepStart = now;
+  if (++stepIndex < scenario.stepCount) {
+    injectedButtons = scenario.steps[stepIndex].buttons;
+    return;
+  }
+
+  injectedButtons = 0;
+  running = false;
+  stepStart = now;
+  if (!reportLcdScenario(scenario, now - scenarioStart)) {
+    failures++;
+  }
+  if (++scenarioIndex == LCD_SCENARIO_COUNT) {
+    Serial.print(F("LCD budget: "));
+    Serial.print(LCD_SCENARIO_COUNT - failures);
+    Serial.print('/');
+    Serial.print(LCD_SCENARIO_COUNT);
+    Serial.println(failures ? F(" FAIL") : F(" PASS"));
+    showMessage("LCD BUDGET", failures ? "FAIL" : "PASS", MAIN, 0);
+  }
+}
+
+#endif // LCD_BUDGET_CHECK
+
+#endif // LCD_BUDGET_H
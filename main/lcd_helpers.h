@@ -91,10 +91,11 @@ void printBigNumber(long long number, int x, int y) {
 
 // Universal function for drawing farm buttons
 void drawFarmButtons() {
-  for (int i = 12; i < 16; i++) {
-    for (int j = 0; j < 2; j++) {
-      lcdPrintAt(i, j, "J");
-    }
+  char row[Panel::WIDTH - Panel::FARM_X_START + 1];
+  memset(row, 'J', sizeof(row) - 1);
+  row[sizeof(row) - 1] = '\0';
+  for (int j = 0; j < Panel::HEIGHT; j++) {
+    lcdPrintAt(Panel::FARM_X_START, j, row);
   }
 }
 
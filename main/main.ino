@@ -1,13 +1,26 @@
 #include "config.h"
 #include "lcd_helpers.h"
+#include "game_state.h"
 #include "game_logic.h"
 #include "ui_screens.h"
 #include "input_handler.h"
 #include "save_system.h"
+#include "achievements.h"
+#include "lcd_budget.h"
+#include "serial_console.h"
+#include "virtual_time.h"
+#include "frame_pacing.h"
+#include "watchdog.h"
 
 void setup() {
-  // Init LCD
-  lcd.begin(16, 2);
+#if WATCHDOG
+  // Before anything in setup() could hang, and before the breadcrumbs are
+  // overwritten; the reset flags were already read in .init3
+  beginWatchdog();
+#endif
+
+  // Init LCD (begin() also clears it)
+  lcd.begin(Panel::WIDTH, Panel::HEIGHT);
   
   // Create Custom Characters
   lcd.createChar(0, starIcon);
@@ -20,99 +33,139 @@ void setup() {
   pinMode(JOY_DOWN, INPUT);
   pinMode(JOY_LEFT, INPUT);
   pinMode(JOY_RIGHT, INPUT);
-  
-  // Clear screen and display initial screen
-  lcd.clear();
-  displayManager();
 
-  // Load progress from EEPROM
-  GameData data;
-  EEPROM.get(0, data);
-  cookies = data.cookies;
-  cookiesPerClick = data.cookiesPerClick;
-  totalCookies = data.totalCookies;
-  totalClicks = data.totalClicks;
-  totalUpgrades = data.totalUpgrades;
-  autoClickLevel = data.autoClickLevel;
-  prestigeClickLevel = data.prestigeClickLevel;
-  prestigeAutoClickLevel = data.prestigeAutoClickLevel;
-  
-  // Sanity checks for loaded data
-  if (autoClickLevel < 0) autoClickLevel = 0;
-  if (prestigeClickLevel < 1) prestigeClickLevel = 1;
-  if (prestigeAutoClickLevel < 0) prestigeAutoClickLevel = 0;
-  
-  lastSavedCookies = cookies;
+#if LCD_BUDGET_CHECK || SERIAL_CONSOLE || VIRTUAL_TIME || HISTORY_SERIAL
+  Serial.begin(SERIAL_BAUD);
+#endif
 
-  randomSeed(analogRead(0));
-  
-  // Initialize milestone for the "new digit" bonus
-  nextMilestone = 100;
-  while (nextMilestone <= cookies && nextMilestone > 0) {
-    nextMilestone *= 10;
+  breadcrumb(STAGE_LOAD);
+  // Load progress from EEPROM before anything is drawn, so the first frame
+  // already shows the saved game
+  GameData data;
+  bootSaveStatus = readSave(data);
+  if (bootSaveStatus != SAVE_BLANK) {
+    loadGame(data);
   }
+  // Achievement cursors start from whatever the save has reached
+  syncAchievements();
+  // Session record in the history log, from the totals just loaded and the
+  // previous run's uptime in the breadcrumbs
+  beginHistory(lastRunUptimeS());
+  // Initialize milestone for the "new digit" bonus
+  nextMilestone = milestoneAfter(game.cookies);
+
+  // Floating analog pin noise and the boot time so far
+  seedGiftRandom(((uint32_t)analogRead(0) << 16) ^ micros());
+  buildGiftTable();
+
+#if WATCHDOG
+  // Serial line, plus a message on the boot frame after a watchdog reset
+  reportWatchdog();
+#endif
+
+  // The one and only boot frame. It is drawn on the screen setup() left, so the
+  // first renderFrame() must not take that for a screen change and draw it again;
+  // displayManager() clears the dirty bits
+  lastScreen = currentScreen;
+  displayManager();
+  // micros() starts in the core's init(), after the bootloader and the global
+  // constructors, so this is core init to the first frame, not reset to it
+  bootTimeUs = micros();
+
+#if LCD_BUDGET_CHECK || SERIAL_CONSOLE || VIRTUAL_TIME
+  Serial.print(F("boot_us="));
+  Serial.print(bootTimeUs);
+  Serial.print(F(" save_status="));
+  Serial.println(bootSaveStatus);
+#endif
 }
 
 void loop() {
+#if WATCHDOG
+  watchdogLoopStart();
+#endif
+  breadcrumb(STAGE_CONSOLE);
+#if LCD_BUDGET_CHECK
+  lcdBudgetTick();
+#endif
+#if SERIAL_CONSOLE
+  pollSerialConsole();
+#elif HISTORY_SERIAL
+  pollHistoryReader();
+#endif
+#if VIRTUAL_TIME
+  advanceVirtualClock();
+#endif
+
+  breadcrumb(STAGE_TIMERS);
   // Check for the milestone bonus
-  if (cookies >= nextMilestone && nextMilestone > 0) {
-      cookies *= 2;
+  if (game.cookies >= nextMilestone && nextMilestone > 0) {
+      setCookies(saturatingAdd(game.cookies, game.cookies));
       showMessage("MILESTONE!", "x2 Cookies!", MAIN, 2000);
-      nextMilestone *= 10;
-      if (nextMilestone == 0) nextMilestone = -1; // overflow, disable
+      nextMilestone = milestoneAfter(game.cookies); // -1 past the last one
+  }
+
+  // Announce a new achievement once nothing else is on screen
+  if (pendingAchievement >= 0 && currentScreen != MESSAGE_SCREEN && !game.congratsActive) {
+    char name[sizeof(AchievementDef::name)];
+    readAchievementName(pendingAchievement, name);
+    showMessage("ACHIEVEMENT!", name, currentScreen, 2000);
+    pendingAchievement = -1;
   }
 
   // Timeout for the message screen
-  if (currentScreen == MESSAGE_SCREEN && messageTimeout > 0 && millis() - messageDisplayStart > messageTimeout) {
+  if (currentScreen == MESSAGE_SCREEN && messageTimeout > 0 && nowMs() - messageDisplayStart > messageTimeout) {
       currentScreen = screenAfterMessage;
       messageTimeout = 0; // Reset timeout
   }
 
   // Gift spawning
-  if (!giftActive && !congratsActive && currentScreen == MAIN && millis() - lastGiftTime > GIFT_INTERVAL) {
-    giftActive = true;
-    giftType = random(GIFT_COUNT);
-    giftPos = GIFT_POSITIONS[random(4)];
-    lastGiftTime = millis();
+  if (!game.giftActive && !game.congratsActive && currentScreen == MAIN && nowMs() - lastGiftTime > GIFT_INTERVAL) {
+    uint8_t type = pickGiftType();
+    spawnGift(type, Panel::GIFT_X_START + giftRandomBelow(Panel::GIFT_SLOTS));
+    lastGiftTime = nowMs();
   }
   // End of temporary bonus
-  if (bonus573Active && millis() - bonus573Start > BONUS573_TIME) {
-    bonus573Active = false;
+  if (game.bonus573Active && nowMs() - bonus573Start > BONUS573_TIME) {
+    setBonus573(false);
   }
   // End of congratulations screen
-  if (congratsActive && millis() - congratsStart > CONGRATS_TIME) {
-    congratsActive = false;
+  if (game.congratsActive && nowMs() - congratsStart > CONGRATS_TIME) {
+    setCongrats(false);
   }
-  // Autoclicker runs only if purchased (level > 0)
-  if (currentScreen == MAIN && autoClickLevel > 0 && millis() - lastAutoClickTime > AUTOCLICK_INTERVAL) {
-    cookies += getAutoClickPower(autoClickLevel);
-    lastAutoClickTime = millis();
+  // Autoclicker and generators, once anything producing has been bought
+  if (currentScreen == MAIN && game.passiveIncome > 0 && nowMs() - lastAutoClickTime > AUTOCLICK_INTERVAL) {
+    collectPassiveIncome();
+    lastAutoClickTime = nowMs();
   }
-  handleJoystick();
-  handleButtonPress();
-  
-  // Clear LCD and redraw everything if screen changed
-  if (currentScreen != lastScreen) {
-    lcd.clear();
-    lastScreen = currentScreen;
-    needRedraw = true;
-    resetPrevScreenVars();
-    // Reset cursor position for new screen
-    prevCursorX = -1;
-    prevCursorY = -1;
+  // Rolling production rates, redrawn once per second while they are on screen
+  if (rateStatsTick() && currentScreen == RATES) {
+    markDirty(DIRTY_RATES);
   }
-  
-  // Cursor blinking - always update
-  if (millis() - lastBlinkTime > BLINK_INTERVAL) {
+  // Buttons at a fixed rate, independent of how long the last frame took
+  breadcrumb(STAGE_INPUT);
+  if (inputSampleDue()) {
+    uint8_t buttons = readJoystickButtons();
+    handleJoystick(buttons);
+    handleButtonPress(buttons);
+  }
+
+  // Cursor blinking
+  if (nowMs() - lastBlinkTime > BLINK_INTERVAL) {
     cursorVisible = !cursorVisible;
-    lastBlinkTime = millis();
-    needRedraw = true;
+    lastBlinkTime = nowMs();
+    game.dirty |= DIRTY_CURSOR;
   }
-  
-  // Always redraw to ensure constant updates
-  displayManager();
-  
-  // Always update cursor for blinking effect - ensure it's visible on symbols
-  displayCursor();
-  needRedraw = false;
-} 
+
+  breadcrumb(STAGE_SAVE);
+  tryAutoSave();
+  breadcrumb(STAGE_HISTORY);
+  historyTick();
+
+  // Everything changed since the last frame is drawn in one go
+  breadcrumb(STAGE_RENDER);
+  if (frameDue()) {
+    renderFrame();
+  }
+  breadcrumb(STAGE_IDLE);
+}
@@ -0,0 +1,143 @@
+#ifndef RATE_STATS_H
+#define RATE_STATS_H
+
+#include "config.h"
+
+// --- PRODUCTION RATES ---
+// Rolling cookies/s and clicks/s over the last 10 s, 1 min and 10 min, shown on
+// the RATES screen and in the console dump. Income is added to the current
+// second; once a second it is pushed through three tiers of ring buffers:
+//
+//   10 x 1 s   -> 10 s window
+//    6 x 10 s  ->  1 min window
+//   10 x 1 min -> 10 min window
+//
+// Each ring keeps a running sum, so a push and a window read are both O(1) and
+// nothing is summed per frame. The longer windows move in whole 10 s / 1 min
+// steps; that is the price of ~100 bytes per series instead of 600 buckets.
+
+const uint8_t RATE_WINDOW_COUNT = 3; // 10 s, 1 min, 10 min
+const unsigned long RATE_SECOND_MS = 1000;
+const unsigned long RATE_LONGEST_WINDOW_MS = 600000UL;
+
+// The last N finished buckets and their sum
+template <typename T, uint8_t N>
+struct RateRing {
+  T buckets[N];
+  long sum;
+  uint8_t head;
+  uint8_t filled; // buckets pushed so far, up to N
+
+  void push(T value) {
+    sum += (long)value - (long)buckets[head];
+    buckets[head] = value;
+    head = (head + 1) % N;
+    if (filled < N) filled++;
+  }
+};
+
+// One measured quantity through all three tiers. Clicks fit in 16-bit buckets,
+// cookies need 32.
+template <typename T>
+struct RateSeries {
+  T pending;       // current second
+  T tenPartial;    // current 10 s
+  T minutePartial; // current minute
+  RateRing<T, 10> seconds;
+  RateRing<T, 6> tens;
+  RateRing<T, 10> minutes;
+
+  void add(T amount) {
+    pending += amount;
+  }
+
+  // Close the current second; `second` counts 1..60 within the minute
+  void closeSecond(uint8_t second) {
+    seconds.push(pending);
+    tenPartial += pending;
+    pending = 0;
+    if (second % 10 == 0) {
+      tens.push(tenPartial);
+      minutePartial += tenPartial;
+      tenPartial = 0;
+    }
+    if (second == 60) {
+      minutes.push(minutePartial);
+      minutePartial = 0;
+    }
+  }
+
+  // Average per second over a window, in tenths (12 means 1.2/s)
+  long tenthsPerSecond(uint8_t window) const {
+    long sum;
+    long covered; // seconds of data in the window so far
+    if (window == 0) {
+      sum = seconds.sum;
+      covered = seconds.filled;
+    } else if (window == 1) {
+      sum = tens.sum;
+      covered = tens.filled * 10L;
+    } else {
+      sum = minutes.sum;
+      covered = minutes.filled * 60L;
+    }
+    if (covered == 0) return 0;
+    return (long)((long long)sum * 10 / covered);
+  }
+};
+
+RateSeries<long> manualRate;      // cookies from clicks
+RateSeries<long> autoRate;        // cookies from the autoclicker and generators
+RateSeries<uint16_t> clickRate;   // clicks
+unsigned long rateSecondStart = 0;
+uint8_t rateSecond = 0;           // seconds closed in the current minute
+uint8_t rateWindow = 0;           // window shown on the RATES screen
+
+const char* const RATE_WINDOW_LABELS[RATE_WINDOW_COUNT] = {"10s", " 1m", "10m"};
+
+void recordManualRate(long amount) {
+  manualRate.add(amount);
+  clickRate.add(1);
+}
+
+void recordAutoRate(long amount) {
+  autoRate.add(amount);
+}
+
+// Called once per loop(); returns true when a second was closed and the rates changed
+bool rateStatsTick() {
+  unsigned long now = nowMs();
+  if (now - rateSecondStart < RATE_SECOND_MS) {
+    return false;
+  }
+  // After a stall longer than every window, all of them would only hold zeros
+  if (now - rateSecondStart >= RATE_LONGEST_WINDOW_MS) {
+    memset(&manualRate, 0, sizeof(manualRate));
+    memset(&autoRate, 0, sizeof(autoRate));
+    memset(&clickRate, 0, sizeof(clickRate));
+    rateSecond = 0;
+    rateSecondStart = now;
+    return true;
+  }
+  while (now - rateSecondStart >= RATE_SECOND_MS) {
+    rateSecond = rateSecond % 60 + 1;
+    manualRate.closeSecond(rateSecond);
+    autoRate.closeSecond(rateSecond);
+    clickRate.closeSecond(rateSecond);
+    rateSecondStart += RATE_SECOND_MS;
+  }
+  return true;
+}
+
+// A rate in tenths as text: "1.2", "345", "12345k"
+void formatRate(char* buf, size_t size, long tenths) {
+  if (tenths < 1000) {
+    snprintf(buf, size, "%ld.%ld", tenths / 10, tenths % 10);
+  } else if (tenths < 10000000L) {
+    snprintf(buf, size, "%ld", tenths / 10);
+  } else {
+    snprintf(buf, size, "%ldk", tenths / 10000);
+  }
+}
+
+#endif // RATE_STATS_H
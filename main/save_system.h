@@ -2,82 +2,141 @@
 #define SAVE_SYSTEM_H
 
 #include "config.h"
+#include "game_state.h"
+#include "gifts.h"
+#include "history_log.h"
 
 // Forward declarations
 void manualSave();
 void showMessage(const char* line1, const char* line2, GameState nextScreen, unsigned long timeout);
 
-void tryAutoSave() {
-  long saveStep = (long)cookiesPerClick * 200;
-  if (saveStep < 1) saveStep = 1;
-  if ((cookies / saveStep) != (lastSavedCookies / saveStep)) {
-    manualSave();
-    lastSavedCookies = cookies;
+#if RAM_STORAGE
+// The simulator saves every virtual AUTOSAVE_INTERVAL, which would wear the
+// EEPROM out in a few runs, and the budget scripts buy, reset and prestige;
+// their saves land here and are only counted
+GameData virtualSaveData;
+SaveFooter virtualSaveFooter;
+#endif
+
+// Fletcher-16 over the save data
+uint16_t saveChecksum(const GameData& data) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+  uint16_t sum1 = 0;
+  uint16_t sum2 = 0;
+  for (size_t i = 0; i < sizeof(data); i++) {
+    sum1 = (sum1 + bytes[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return (sum2 << 8) | sum1;
+}
+
+// Read the save record and say how far it can be trusted
+SaveStatus readSave(GameData& data) {
+  EEPROM.get(SAVE_ADDRESS, data);
+  SaveFooter footer;
+  EEPROM.get(SAVE_FOOTER_ADDRESS, footer);
+  if (footer.magic == SAVE_MAGIC && footer.checksum == saveChecksum(data)) {
+    return SAVE_VALID;
   }
-  needRedraw = true;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+  for (size_t i = 0; i < sizeof(data); i++) {
+    if (bytes[i] != 0xFF) {
+      // Without a checksum the bitset can't be trusted (an older layout has its
+      // footer there); syncAchievements() re-unlocks whatever the counters prove
+      memset(data.achievements, 0, sizeof(data.achievements));
+      return SAVE_UNVERIFIED;
+    }
+  }
+  return SAVE_BLANK;
+}
+
+// Persist only when a saved field actually changed: purchases, gifts and
+// prestige at once, the drifting counters (DIRTY_DRIFT) not more often than
+// AUTOSAVE_INTERVAL to spare the EEPROM
+void tryAutoSave() {
+  if (!(game.unsaved & DIRTY_PERSISTENT)) return;
+  bool driftOnly = !(game.unsaved & DIRTY_PERSISTENT & ~DIRTY_DRIFT);
+  if (driftOnly && nowMs() - lastSaveTime < AUTOSAVE_INTERVAL) return;
+  manualSave();
 }
 
 void manualSave() {
   GameData data = {
-    cookies,
-    cookiesPerClick,
-    totalCookies,
-    totalClicks,
-    totalUpgrades,
-    autoClickLevel,
-    prestigeClickLevel,
-    prestigeAutoClickLevel
+    game.cookies,
+    game.cookiesPerClick,
+    game.totalCookies,
+    game.totalClicks,
+    game.totalUpgrades,
+    game.autoClickLevel,
+    game.prestigeClickLevel,
+    game.prestigeAutoClickLevel,
+    {0}, // generatorLevels, copied below
+    {0}  // achievements, copied below
   };
-  EEPROM.put(0, data);
-  lastSavedCookies = cookies;
-  needRedraw = true;
+  memcpy(data.generatorLevels, game.generatorLevels, sizeof(data.generatorLevels));
+  memcpy(data.achievements, game.achievements, sizeof(data.achievements));
+  SaveFooter footer = {SAVE_MAGIC, saveChecksum(data)};
+#if RAM_STORAGE
+  virtualSaveData = data;
+  virtualSaveFooter = footer;
+#else
+  EEPROM.put(SAVE_ADDRESS, data);
+  EEPROM.put(SAVE_FOOTER_ADDRESS, footer);
+#endif
+  saveCount++;
+  lastSaveTime = nowMs();
+  game.unsaved = 0;
 }
 
 void manualReset() {
-  cookies = 0;
-  cookiesPerClick = prestigeClickLevel;
-  totalCookies = 0;
-  totalClicks = 0;
-  totalUpgrades = 0;
-  autoClickLevel = prestigeAutoClickLevel;
+  setCookies(0);
+  setCookiesPerClick(game.prestigeClickLevel);
+  resetTotals();
+  setAutoClickLevel(game.prestigeAutoClickLevel);
+  resetGenerators();
   manualSave();
-  needRedraw = true;
 }
 
 void activatePrestige() {
-    if (cookies >= 1750000) {
-        prestigeClickLevel = 10;
-        prestigeAutoClickLevel = 5;
-    } else if (cookies >= 1000000) {
-        prestigeClickLevel = 8;
-        prestigeAutoClickLevel = 3;
+    if (game.cookies >= 1750000) {
+        setPrestigeLevels(10, 5);
+    } else if (game.cookies >= 1000000) {
+        setPrestigeLevels(8, 3);
     }
+    noteHistoryPrestige();
     manualReset();
     currentScreen = MAIN;
-    needRedraw = true;
 }
 
 void activateGift() {
-  static const long cookieRewards[] = {100, 500, 1000, 5000, 10000, 15000};
-  if (giftType < 6) {
-    cookies += cookieRewards[giftType];
-    totalCookies += cookieRewards[giftType];
-  } else if (giftType == 6) {
-    cookiesPerClick += 50;
-    showMessage("BOUGHT", "+50 to click", MAIN, 2000);
-  } else if (giftType == 7) {
-    cookiesPerClick += 2;
-    totalUpgrades++;
-    showMessage("BOUGHT", "+1 level", MAIN, 2000);
-  } else if (giftType == 8) {
-    bonus573Active = true;
-    bonus573Start = millis();
+  GiftDef gift = readGift(game.giftType);
+  char text[16];
+  switch (gift.kind) {
+    case GIFT_COOKIES:
+      earnCookies(gift.amount);
+      break;
+    case GIFT_CLICK_POWER:
+      setCookiesPerClick(game.cookiesPerClick + gift.amount);
+      snprintf(text, sizeof(text), "+%ld to click", gift.amount);
+      showMessage("BOUGHT", text, MAIN, 2000);
+      break;
+    case GIFT_CLICK_LEVEL:
+      // A click level is worth 2 cookies per click (see getLevel())
+      setCookiesPerClick(game.cookiesPerClick + 2 * gift.amount);
+      for (long level = 0; level < gift.amount; level++) addUpgrade();
+      snprintf(text, sizeof(text), "+%ld level", gift.amount);
+      showMessage("BOUGHT", text, MAIN, 2000);
+      break;
+    case GIFT_CLICK_BONUS:
+      giftClickBonus = gift.amount;
+      setBonus573(true);
+      bonus573Start = nowMs();
+      break;
   }
-  tryAutoSave();
-  giftActive = false;
-  congratsActive = true;
-  congratsStart = millis();
-  needRedraw = true;
+  manualSave(); // a cookie gift only touches the drifting counters, so don't wait for those
+  clearGift();
+  setCongrats(true);
+  congratsStart = nowMs();
 }
 
 #endif // SAVE_SYSTEM_H 
@@ -0,0 +1,240 @@
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include "config.h"
+#include "game_state.h"
+#include "save_system.h"
+#include "achievements.h"
+#include "frame_pacing.h"
+#include "watchdog.h"
+
+#if SERIAL_CONSOLE
+
+// --- SERIAL COMMAND CONSOLE ---
+// One command per line, 115200 baud. Reads whatever has arrived without waiting,
+// so it never stalls a frame, and parses in place in a fixed buffer (no heap).
+// Dumps go out one line per pass, and only once the TX buffer has room for the
+// whole line, so printing never waits either; the next command is read after
+// the dump's OK.
+//
+//   cookies <n>        set cookies
+//   level <n>          set the click level (SHOP level)
+//   auto <n>           set the autoclicker level
+//   gen <type> <n>     set how many of generator <type> are owned
+//   gift <type>        spawn and open gift <type> (0..GIFT_COUNT-1)
+//   save | reset | prestige
+//   joy <cudlr> <ms>   hold joystick buttons, e.g. "joy r 150", "joy c 5000"
+//   dump               print state and counters
+//   history            print the session history log
+
+const uint8_t CONSOLE_LINE_MAX = 32;
+const uint8_t CONSOLE_MAX_CHARS_PER_LOOP = 16; // bounds the time spent per frame
+
+enum ConsoleDump : uint8_t {
+  DUMP_NONE,
+  DUMP_STATE,
+  DUMP_HISTORY
+};
+
+char consoleLine[CONSOLE_LINE_MAX + 1];
+uint8_t consoleLength = 0;
+bool consoleOverflow = false;
+unsigned long injectStart = 0;
+unsigned long injectDuration = 0;
+ConsoleDump consoleDump = DUMP_NONE;
+uint8_t consoleDumpLine = 0;
+
+// Split off the next space-separated token, or return nullptr
+char* nextConsoleToken(char*& p) {
+  while (*p == ' ') p++;
+  if (*p == '\0') return nullptr;
+  char* token = p;
+  while (*p != '\0' && *p != ' ') p++;
+  if (*p == ' ') *p++ = '\0';
+  return token;
+}
+
+bool parseConsoleLong(const char* token, long& value) {
+  if (token == nullptr) return false;
+  char* end;
+  value = strtol(token, &end, 10);
+  return end != token && *end == '\0';
+}
+
+// "cudlr" letters to a JOY_MASK_* bitmask
+bool parseConsoleButtons(const char* token, uint8_t& buttons) {
+  if (token == nullptr) return false;
+  buttons = 0;
+  for (; *token; token++) {
+    switch (*token) {
+      case 'c': buttons |= JOY_MASK_CENTER; break;
+      case 'u': buttons |= JOY_MASK_UP; break;
+      case 'd': buttons |= JOY_MASK_DOWN; break;
+      case 'l': buttons |= JOY_MASK_LEFT; break;
+      case 'r': buttons |= JOY_MASK_RIGHT; break;
+      default: return false;
+    }
+  }
+  return true;
+}
+
+void printConsoleValue(const __FlashStringHelper* label, long value) {
+  Serial.print(label);
+  Serial.println(value);
+}
+
+template <typename T>
+void printConsoleRates(const __FlashStringHelper* label, const RateSeries<T>& series) {
+  Serial.print(label);
+  for (uint8_t w = 0; w < RATE_WINDOW_COUNT; w++) {
+    if (w > 0) Serial.print(',');
+    Serial.print(series.tenthsPerSecond(w));
+  }
+  Serial.println();
+}
+
+// Prints line `line` of the state dump; false once past the last one
+bool dumpConsoleStateLine(uint8_t line) {
+  uint8_t n = 0;
+  if (line == n++) printConsoleValue(F("uptime_ms="), nowMs());
+  if (line == n++) printConsoleValue(F("boot_us="), bootTimeUs);
+  if (line == n++) printConsoleValue(F("save_status="), bootSaveStatus);
+#if WATCHDOG
+  if (line == n++) printConsoleValue(F("reset_flags="), resetFlags);
+  if (line == n++) printConsoleValue(F("worst_loop_ms="), breadcrumbs.worstLoopMs);
+#endif
+  if (line == n++) printConsoleValue(F("screen="), currentScreen);
+  if (line == n++) printConsoleValue(F("cookies="), game.cookies);
+  if (line == n++) printConsoleValue(F("per_click="), game.cookiesPerClick);
+  if (line == n++) printConsoleValue(F("total_cookies="), game.totalCookies);
+  if (line == n++) printConsoleValue(F("total_clicks="), game.totalClicks);
+  if (line == n++) printConsoleValue(F("total_upgrades="), game.totalUpgrades);
+  if (line == n++) printConsoleValue(F("auto_level="), game.autoClickLevel);
+  if (line == n++) printConsoleValue(F("prestige_click="), game.prestigeClickLevel);
+  if (line == n++) printConsoleValue(F("prestige_auto="), game.prestigeAutoClickLevel);
+  for (uint8_t type = 0; type < GENERATOR_COUNT; type++) {
+    if (line == n++) {
+      Serial.print(F("gen"));
+      Serial.print(type);
+      printConsoleValue(F("="), game.generatorLevels[type]);
+    }
+  }
+  if (line == n++) printConsoleValue(F("passive_income="), game.passiveIncome);
+  if (line == n++) printConsoleValue(F("achievements="), countAchievements());
+  if (line == n++) printConsoleValue(F("unsaved="), game.unsaved);
+  if (line == n++) printConsoleValue(F("saves="), saveCount);
+  if (line == n++) printConsoleValue(F("lcd_bytes="), lcd.traffic.bytes);
+  if (line == n++) printConsoleValue(F("lcd_bus_bytes="), lcd.traffic.busBytes);
+  if (line == n++) printConsoleValue(F("lcd_set_cursor="), lcd.traffic.setCursors);
+  if (line == n++) printConsoleValue(F("lcd_clears="), lcd.traffic.clears);
+  if (line == n++) printConsoleValue(F("frames="), frameCount);
+  if (line == n++) printConsoleValue(F("frame_overruns="), frameOverruns);
+  if (line == n++) printConsoleValue(F("worst_frame_us="), worstFrameUs);
+  // Rates per second x10, one value per window: 10 s, 1 min, 10 min
+  if (line == n++) printConsoleRates(F("rate_manual_x10="), manualRate);
+  if (line == n++) printConsoleRates(F("rate_auto_x10="), autoRate);
+  if (line == n++) printConsoleRates(F("rate_clicks_x10="), clickRate);
+  return line < n;
+}
+
+// Returns false for an unknown command or bad arguments
+bool runConsoleCommand(char* line) {
+  char* p = line;
+  char* command = nextConsoleToken(p);
+  if (command == nullptr) return true; // empty line
+  long value;
+
+  if (strcmp_P(command, PSTR("cookies")) == 0) {
+    if (!parseConsoleLong(nextConsoleToken(p), value) || value < 0) return false;
+    setCookies(value);
+    nextMilestone = milestoneAfter(value); // a test value is not a milestone reached
+  } else if (strcmp_P(command, PSTR("level")) == 0) {
+    if (!parseConsoleLong(nextConsoleToken(p), value) || value < 1) return false;
+    // Inverse of getLevel(): level 1 is 1 cookie per click, then +2 per level
+    setCookiesPerClick(value == 1 ? 1 : (value - 1) * 2);
+  } else if (strcmp_P(command, PSTR("auto")) == 0) {
+    if (!parseConsoleLong(nextConsoleToken(p), value) || value < 0) return false;
+    setAutoClickLevel(value);
+  } else if (strcmp_P(command, PSTR("gen")) == 0) {
+    long level;
+    if (!parseConsoleLong(nextConsoleToken(p), value) || value < 0 || value >= GENERATOR_COUNT) return false;
+    if (!parseConsoleLong(nextConsoleToken(p), level) || level < 0 || level > GENERATOR_MAX_LEVEL) return false;
+    setGeneratorLevel(value, level);
+  } else if (strcmp_P(command, PSTR("gift")) == 0) {
+    if (!parseConsoleLong(nextConsoleToken(p), value) || value < 0 || value >= GIFT_COUNT) return false;
+    spawnGift(value, game.giftPos);
+    activateGift();
+  } else if (strcmp_P(command, PSTR("save")) == 0) {
+    manualSave();
+  } else if (strcmp_P(command, PSTR("reset")) == 0) {
+    manualReset();
+  } else if (strcmp_P(command, PSTR("prestige")) == 0) {
+    activatePrestige();
+  } else if (strcmp_P(command, PSTR("joy")) == 0) {
+    uint8_t buttons;
+    if (!parseConsoleButtons(nextConsoleToken(p), buttons)) return false;
+    if (!parseConsoleLong(nextConsoleToken(p), value) || value <= 0) return false;
+    injectedButtons = buttons;
+    injectStart = nowMs();
+    injectDuration = value;
+  } else if (strcmp_P(command, PSTR("dump")) == 0) {
+    consoleDump = DUMP_STATE;
+    consoleDumpLine = 0;
+  } else if (strcmp_P(command, PSTR("history")) == 0) {
+    consoleDump = DUMP_HISTORY;
+    beginHistoryDump();
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Called once per loop()
+void pollSerialConsole() {
+  // Release injected buttons when their time is up
+  if (injectDuration > 0 && nowMs() - injectStart >= injectDuration) {
+    injectedButtons = 0;
+    injectDuration = 0;
+  }
+
+  if (consoleDump != DUMP_NONE) {
+    if (Serial.availableForWrite() < SERIAL_DUMP_LINE_MAX) return;
+    bool more = consoleDump == DUMP_STATE ? dumpConsoleStateLine(consoleDumpLine++) : dumpHistoryLine();
+    if (!more) {
+      consoleDump = DUMP_NONE;
+      Serial.println(F("OK"));
+    }
+    return;
+  }
+
+  for (uint8_t n = 0; n < CONSOLE_MAX_CHARS_PER_LOOP && Serial.available() > 0; n++) {
+    char c = Serial.read();
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (consoleLength < CONSOLE_LINE_MAX) {
+        consoleLine[consoleLength++] = c;
+      } else {
+        consoleOverflow = true; // keep swallowing until the end of the line
+      }
+      continue;
+    }
+
+    consoleLine[consoleLength] = '\0';
+    if (consoleOverflow) {
+      Serial.println(F("ERR line too long"));
+    } else if (!runConsoleCommand(consoleLine)) {
+      Serial.println(F("ERR"));
+    } else if (consoleDump != DUMP_NONE) {
+      consoleLength = 0;
+      return; // OK follows the dump
+    } else {
+      Serial.println(F("OK"));
+    }
+    consoleLength = 0;
+    consoleOverflow = false;
+  }
+}
+
+#endif // SERIAL_CONSOLE
+
+#endif // SERIAL_CONSOLE_H
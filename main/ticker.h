@@ -0,0 +1,84 @@
+#ifndef TICKER_H
+#define TICKER_H
+
+#include "config.h"
+#include "lcd_helpers.h"
+
+// --- TEXT SCREENS AND TICKER ---
+// Full-screen text (messages, congrats). On a 2-row panel, text wider than the
+// panel is written once across the whole 40-column DDRAM rows and scrolled
+// with the controller's display-shift instruction: one command byte per step
+// instead of rewriting every visible cell. Both rows shift together, and the
+// DDRAM rows are circular, so the text comes round again after 40 steps.
+// On 4-row panels DDRAM rows continue onto rows 2 and 3, so shifting would
+// scramble them; there each text line takes two rows instead.
+
+const unsigned long TICKER_STEP_MS = 300;
+const uint8_t TICKER_HOLD_STEPS = 4; // pause with the start of the text in view
+
+bool tickerActive = false;
+uint8_t tickerShift = 0;             // columns shifted so far, 0..HD44780_DDRAM_ROW-1
+uint8_t tickerHold = 0;
+unsigned long tickerLastStep = 0;
+
+// Undo the shift so ordinary drawing lines up with the panel again
+void stopTicker() {
+  if (tickerShift != 0) {
+    lcd.home(); // also resets the display shift
+  }
+  tickerActive = false;
+  tickerShift = 0;
+}
+
+// Text shown on row `y`: one line per row, or two rows per line on 4-row panels
+const char* textScreenRow(const char* line1, const char* line2, int y) {
+  if (Panel::HEIGHT >= 4) {
+    const char* line = y < 2 ? line1 : line2;
+    size_t offset = (y % 2) * LCD_WIDTH;
+    return strlen(line) > offset ? line + offset : "";
+  }
+  return y == 0 ? line1 : (y == 1 ? line2 : "");
+}
+
+void drawTextScreen(const char* line1, const char* line2) {
+  stopTicker();
+  size_t length1 = strlen(line1);
+  size_t length2 = strlen(line2);
+  size_t longest = length1 > length2 ? length1 : length2;
+  if (Panel::HEIGHT == 2 && longest > (size_t)LCD_WIDTH) {
+    char buf[HD44780_DDRAM_ROW + 1];
+    snprintf(buf, sizeof(buf), "%-*s", HD44780_DDRAM_ROW, line1);
+    lcdPrintAt(0, 0, buf);
+    snprintf(buf, sizeof(buf), "%-*s", HD44780_DDRAM_ROW, line2);
+    lcdPrintAt(0, 1, buf);
+    tickerActive = true;
+    tickerHold = TICKER_HOLD_STEPS;
+    tickerLastStep = nowMs();
+    return;
+  }
+  char buf[LCD_WIDTH + 1];
+  for (int y = 0; y < Panel::HEIGHT; y++) {
+    snprintf(buf, sizeof(buf), "%-*s", LCD_WIDTH, textScreenRow(line1, line2, y));
+    lcdPrintAt(0, y, buf);
+  }
+}
+
+// Called once per loop(); one shift command per step
+void tickerTick() {
+  if (!tickerActive || nowMs() - tickerLastStep < TICKER_STEP_MS) {
+    return;
+  }
+  tickerLastStep = nowMs();
+  if (tickerHold > 0) {
+    tickerHold--;
+    return;
+  }
+  lcd.command(HD44780_SHIFT_LEFT);
+  lcd.flush();
+  tickerShift = (tickerShift + 1) % HD44780_DDRAM_ROW;
+  if (tickerShift == 0) {
+    tickerHold = TICKER_HOLD_STEPS;
+  }
+}
+
+#endif // TICKER_H
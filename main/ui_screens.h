@@ -4,6 +4,9 @@
 #include "config.h"
 #include "lcd_helpers.h"
 #include "game_logic.h"
+#include "game_state.h"
+#include "ticker.h"
+#include "gifts.h"
 
 // Forward declarations
 void displayMainScreen();
@@ -13,20 +16,21 @@ void displayAScreen();
 void displayPrestigeConfirmScreen();
 void displayMessageScreen();
 void displayCongratsScreen();
+void displayRatesScreen();
+void displayGeneratorScreen();
 void displayCursor();
 void redrawElementAt(int x, int y);
-void resetPrevScreenVars();
 
 void showMessage(const char* line1, const char* line2, GameState nextScreen, unsigned long timeout) {
-    strncpy(messageLine1, line1, 16);
-    messageLine1[16] = '\0';
-    strncpy(messageLine2, line2, 16);
-    messageLine2[16] = '\0';
+    strncpy(messageLine1, line1, MESSAGE_MAX);
+    messageLine1[MESSAGE_MAX] = '\0';
+    strncpy(messageLine2, line2, MESSAGE_MAX);
+    messageLine2[MESSAGE_MAX] = '\0';
     currentScreen = MESSAGE_SCREEN;
     screenAfterMessage = nextScreen;
     messageTimeout = timeout;
     if (timeout > 0) {
-        messageDisplayStart = millis();
+        messageDisplayStart = nowMs();
     }
     // Reset cursor position for message screen and ensure it's visible
     cursorX = 0;
@@ -34,11 +38,30 @@ void showMessage(const char* line1, const char* line2, GameState nextScreen, uns
     prevCursorX = -1;
     prevCursorY = -1;
     cursorVisible = true; // Ensure cursor is visible
-    needRedraw = true;
+    requestFullRedraw();
 }
 
 void displayManager() {
-  if (congratsActive) {
+  // Cursor moves are picked up here rather than at every write to cursorX/cursorY
+  if (cursorX != prevCursorX || cursorY != prevCursorY) {
+    game.dirty |= DIRTY_CURSOR;
+  }
+  // Steady state: nothing changed, so no formatting and no LCD I/O
+  if (!game.dirty) {
+    return;
+  }
+
+  // The congrats overlay keeps currentScreen == MAIN, so its edges are handled here:
+  // one clear when it appears and one full MAIN redraw when it goes away
+  if (game.dirty & DIRTY_CONGRATS) {
+    stopTicker();
+    lcd.clear();
+    requestFullRedraw();
+    prevCursorX = -1;
+    prevCursorY = -1;
+  }
+
+  if (game.congratsActive) {
     displayCongratsScreen();
   } else {
     switch (currentScreen) {
@@ -60,131 +83,241 @@ void displayManager() {
       case MESSAGE_SCREEN:
         displayMessageScreen();
         break;
+      case RATES:
+        displayRatesScreen();
+        break;
+      case GENERATOR_SHOP:
+        displayGeneratorScreen();
+        break;
     }
   }
-  // Always update cursor for blinking effect - ensure it's visible on all screens
+  // A field redraw may have overwritten the cursor cell, so it is always restored
   displayCursor();
+  lcd.flush(); // batched backends send the whole frame here
+  game.dirty = 0;
 }
 
-void displayMainScreen() {
-  if (cookies != prevState.cookies) {
-    // Draw cookies and stats button together
-    char buf[12];
-    snprintf(buf, sizeof(buf), "%ld", cookies);
-    int cookieDigits = strlen(buf);
-    if (cookieDigits > MAX_DIGITS) cookieDigits = MAX_DIGITS;
-    int cookiePos = 0;
-    // Clear the whole area first
-    lcdPrintAt(cookiePos, 0, "                ");
-    // Print cookies
-    lcd.setCursor(cookiePos, 0);
-    lcd.print(buf);
-    lcd.print("S"); // Только S после печенек
-    prevState.cookies = cookies;
+// --- Row formatting ---
+// Screens with numbers build their rows as text; the renderers print whole rows
+// and redrawElementAt() takes single characters from the same text.
+// Buffers are LCD_WIDTH + 1 and every row comes out exactly LCD_WIDTH wide.
+
+// Space-fill a formatted row up to `width` characters
+void padRow(char* buf, int width) {
+  int len = strlen(buf);
+  while (len < width) {
+    buf[len++] = ' ';
+  }
+  buf[width] = '\0';
+}
+
+// Cookies followed by the stats button, padded up to the gift area
+void formatCookieField(char* buf, size_t size) {
+  int len = formatCookieCount(buf, size, game.cookies);
+  buf[len] = 'S';
+  buf[len + 1] = '\0';
+  padRow(buf, Panel::GIFT_X_START);
+}
+
+void formatShopRow(char* buf, size_t size, int row) {
+  if (row == 0) {
+    snprintf(buf, size, "^%7ld%*d", (long)calculateUpgradeCost(), LCD_WIDTH - 8,
+             getNextClickPower(game.cookiesPerClick));
+  } else if (row == 1) {
+    snprintf(buf, size, "< Your Level%*d", LCD_WIDTH - 12, getLevel(game.cookiesPerClick));
+  } else {
+    buf[0] = '\0';
+  }
+  padRow(buf, LCD_WIDTH);
+}
+
+void formatAutoClickRow(char* buf, size_t size, int row) {
+  int level = game.autoClickLevel < 0 ? 0 : game.autoClickLevel;
+  if (row == 0) {
+    snprintf(buf, size, "^%7ld%*d", (long)calculateAutoClickUpgradeCost(), LCD_WIDTH - 8,
+             getAutoClickPower(level + 1));
+  } else if (row == 1) {
+    snprintf(buf, size, "< Your Level%*d", LCD_WIDTH - 12, level);
+  } else {
+    buf[0] = '\0';
+  }
+  padRow(buf, LCD_WIDTH);
+}
+
+// Taller panels get the autoclicker and prestige levels on rows 2 and 3
+void formatStatsRow(char* buf, size_t size, int row) {
+  if (row == 0) {
+    snprintf(buf, size, "T:%*ld >S", LCD_WIDTH - 5, game.totalCookies);
+  } else if (row == 1) {
+    snprintf(buf, size, "<L:%-2dU:%-2ldC:%-*ld", getLevel(game.cookiesPerClick),
+             game.totalUpgrades, LCD_WIDTH - 12, game.totalClicks);
+    padRow(buf, LCD_WIDTH);
+    buf[BUTTON_RESET_X] = 'R';
+  } else if (row == 2) {
+    snprintf(buf, size, "Auto level %d", game.autoClickLevel);
+  } else {
+    snprintf(buf, size, "Prestige %d/%d", game.prestigeClickLevel, game.prestigeAutoClickLevel);
+  }
+  padRow(buf, LCD_WIDTH);
+}
+
+// Row 0: window and clicks/s, row 1: cookies/s from clicks (M) and passive income (A)
+void formatRatesRow(char* buf, size_t size, int row) {
+  char rate[12];
+  if (row == 0) {
+    formatRate(rate, sizeof(rate), clickRate.tenthsPerSecond(rateWindow));
+    snprintf(buf, size, "<%s clk%*s >", RATE_WINDOW_LABELS[rateWindow], LCD_WIDTH - 10, rate);
+  } else if (row == 1) {
+    const int manualWidth = (LCD_WIDTH - 3) / 2;
+    formatRate(rate, sizeof(rate), manualRate.tenthsPerSecond(rateWindow));
+    int len = snprintf(buf, size, "M%*s A", manualWidth, rate);
+    formatRate(rate, sizeof(rate), autoRate.tenthsPerSecond(rateWindow));
+    snprintf(buf + len, size - len, "%*s", LCD_WIDTH - 3 - manualWidth, rate);
+  } else {
+    buf[0] = '\0';
   }
-  if (giftActive != prevState.giftActive || giftPos != prevState.giftPos) {
-    if (giftActive) {
-      lcdPrintAt(giftPos, 0, "#");
-    } else if (prevState.giftActive) {
-      lcdPrintAt(prevState.giftPos, 0, " ");
+  padRow(buf, LCD_WIDTH);
+}
+
+// One building at a time: price and name, then owned count and yield per
+// building; '>' steps to the next type. Taller panels add the total income.
+// The price is abbreviated to 7 columns, or MAX once no amount of cookies buys it.
+void formatGeneratorRow(char* buf, size_t size, int row) {
+  GeneratorDef def = readGenerator(generatorShopIndex);
+  if (row == 0) {
+    char cost[12] = "MAX";
+    if (!isGeneratorMaxed(generatorShopIndex)) {
+      formatShortNumber(cost, sizeof(cost), calculateGeneratorCost(generatorShopIndex), 7);
     }
-    prevState.giftActive = giftActive;
-    prevState.giftPos = giftPos;
+    snprintf(buf, size, "^%7s %-*s", cost, LCD_WIDTH - 9, def.name);
+  } else if (row == 1) {
+    snprintf(buf, size, "< Lv%-3d +%-*ld >", game.generatorLevels[generatorShopIndex],
+             LCD_WIDTH - 11, def.yield);
+  } else if (row == 2) {
+    snprintf(buf, size, "Income %ld/s", game.passiveIncome);
+  } else {
+    buf[0] = '\0';
+  }
+  padRow(buf, LCD_WIDTH);
+}
+
+void displayMainScreen() {
+  if (isDirty(DIRTY_COOKIES)) {
+    char buf[LCD_WIDTH + 1];
+    formatCookieField(buf, sizeof(buf));
+    lcdPrintAt(0, 0, buf);
+  }
+  if (isDirty(DIRTY_GIFT)) {
+    lcdPrintAt(game.giftPos, 0, game.giftActive ? "#" : " ");
+  }
+  if (game.dirty & DIRTY_SCREEN) {
+    lcdPrintAt(BUTTON_SHOP_X_START, BUTTON_MENU_Y, F("SHOP"));
+    lcdPrintAt(BUTTON_AUTOCLICK_X, BUTTON_MENU_Y, "a");
+    lcdPrintAt(BUTTON_PRESTIGE_X, BUTTON_MENU_Y, "*"); // Звездочка для престижа
+    lcdPrintAt(BUTTON_GENERATOR_X, BUTTON_MENU_Y, "g");
+    drawFarmButtons();
   }
-  lcdPrintAt(0, 1, F("SHOP"));
-  lcdPrintAt(4, 1, "a");
-  lcdPrintAt(BUTTON_PRESTIGE_X, 1, "*"); // Звездочка для престижа
-  drawFarmButtons();
 }
 
 void displayShopScreen() {
-  long long cost = calculateUpgradeCost();
-  int nextClick = getNextClickPower(cookiesPerClick);
-  int level = getLevel(cookiesPerClick);
-  if (cost != prevState.shopCost || nextClick != prevState.shopNextClick || level != prevState.shopLevel) {
-    lcdPrintAt(0, 0, "^");
-    lcdPrintAt(1, 0, "           ");
-    printRightAligned(cost, 1, 0, 4);
-    drawRightAlignedLabel(nextClick, 0);
-    lcdPrintAt(0, 1, "<");
-    lcdPrintAt(2, 1, F("Your Level"));
-    drawRightAlignedLabel(level, 1);
-    prevState.shopCost = cost;
-    prevState.shopNextClick = nextClick;
-    prevState.shopLevel = level;
+  if (isDirty(DIRTY_CLICK_POWER)) {
+    char buf[LCD_WIDTH + 1];
+    formatShopRow(buf, sizeof(buf), 0);
+    lcdPrintAt(0, 0, buf);
+    formatShopRow(buf, sizeof(buf), 1);
+    lcdPrintAt(0, 1, buf);
   }
 }
 
 void displayPrestigeConfirmScreen() {
+  if (game.dirty & DIRTY_SCREEN) {
     lcdPrintAt(0, 0, F("ARE YOU SURE?"));
     lcdPrintAt(0, 1, F("NO"));
     lcdPrintAt(6, 1, F("YES"));
+  }
 }
 
 void displayMessageScreen() {
-    // Always redraw message screen to ensure cursor visibility
-    lcdPrintAt(0, 0, messageLine1);
-    lcdPrintAt(0, 1, messageLine2);
+  if (game.dirty & DIRTY_SCREEN) {
+    // Padded so a message replacing another one leaves nothing behind
+    drawTextScreen(messageLine1, messageLine2);
+  }
 }
 
 void displayStarScreen() {
-  if (totalCookies != prevState.totalCookies ||
-      getLevel(cookiesPerClick) != prevState.statsLevel ||
-      totalUpgrades != prevState.totalUpgrades ||
-      totalClicks != prevState.totalClicks) {
-    lcdPrintAt(0, 0, F("T:"));
-    char buf[13];
-    snprintf(buf, sizeof(buf), "%11ld", totalCookies);
-    for (int i = 0; i < 11; i++) {
-      lcdPrintAt(2 + i, 0, buf[i]);
-    }
-    lcdPrintAt(15, 0, "S");
-    lcdPrintAt(0, 1, "<");
-    lcdPrintAt(1, 1, F("L:"));
-    lcdPrintAt(3, 1, getLevel(cookiesPerClick));
-    lcdPrintAt(5, 1, F(" U:"));
-    lcdPrintAt(7, 1, totalUpgrades);
-    lcdPrintAt(9, 1, F(" C:"));
-    lcdPrintAt(11, 1, totalClicks);
-    lcdPrintAt(15, 1, "R");
-    prevState.totalCookies = totalCookies;
-    prevState.statsLevel = getLevel(cookiesPerClick);
-    prevState.totalUpgrades = totalUpgrades;
-    prevState.totalClicks = totalClicks;
+  char buf[LCD_WIDTH + 1];
+  if (isDirty(DIRTY_TOTAL_COOKIES)) {
+    formatStatsRow(buf, sizeof(buf), 0);
+    lcdPrintAt(0, 0, buf);
+  }
+  if (isDirty(DIRTY_CLICK_POWER | DIRTY_TOTAL_UPGRADES | DIRTY_TOTAL_CLICKS)) {
+    formatStatsRow(buf, sizeof(buf), 1);
+    lcdPrintAt(0, 1, buf);
+  }
+  if (Panel::HEIGHT > 2 && isDirty(DIRTY_AUTOCLICK)) {
+    formatStatsRow(buf, sizeof(buf), 2);
+    lcdPrintAt(0, 2, buf);
+  }
+  if (Panel::HEIGHT > 3 && isDirty(DIRTY_PRESTIGE)) {
+    formatStatsRow(buf, sizeof(buf), 3);
+    lcdPrintAt(0, 3, buf);
+  }
+}
+
+void displayRatesScreen() {
+  if (isDirty(DIRTY_RATES)) {
+    char buf[LCD_WIDTH + 1];
+    formatRatesRow(buf, sizeof(buf), 0);
+    lcdPrintAt(0, 0, buf);
+    formatRatesRow(buf, sizeof(buf), 1);
+    lcdPrintAt(0, 1, buf);
   }
 }
 
+void displayGeneratorScreen() {
+  char buf[LCD_WIDTH + 1];
+  if (isDirty(DIRTY_GENERATORS)) {
+    formatGeneratorRow(buf, sizeof(buf), 0);
+    lcdPrintAt(0, 0, buf);
+    formatGeneratorRow(buf, sizeof(buf), 1);
+    lcdPrintAt(0, 1, buf);
+  }
+  if (Panel::HEIGHT > 2 && isDirty(DIRTY_GENERATORS | DIRTY_AUTOCLICK)) {
+    formatGeneratorRow(buf, sizeof(buf), 2);
+    lcdPrintAt(0, 2, buf);
+  }
+}
+
+// Drawn once per gift; clearing here every frame made the panel flicker
 void displayCongratsScreen() {
-  lcd.clear();
-  lcdPrintAt(0, 0, F("Congratulations"));
-  lcdPrintAt(0, 1, GIFT_TEXTS[giftType]);
-  needRedraw = true;
+  if (game.dirty & DIRTY_SCREEN) {
+    char text[MESSAGE_MAX + 1];
+    readGiftText(game.giftType, text);
+    drawTextScreen("Congratulations", text);
+  }
 }
 
 void displayAScreen() {
-  long long cost = calculateAutoClickUpgradeCost();
-  int income = getAutoClickPower(autoClickLevel < 0 ? 1 : autoClickLevel + 1);
-  int level = autoClickLevel < 0 ? 0 : autoClickLevel;
-  if (cost != prevState.autoCost || income != prevState.autoIncome || level != prevState.autoLevel) {
-    lcdPrintAt(0, 0, "^");
-    printRightAligned(cost, 1, 0, 4);
-    char incbuf[4];
-    snprintf(incbuf, sizeof(incbuf), "%3d", income);
-    lcdPrintAt(13, 0, incbuf);
-    lcdPrintAt(0, 1, "<");
-    lcdPrintAt(2, 1, F("Your Level"));
-    char lvlbuf[4];
-    snprintf(lvlbuf, sizeof(lvlbuf), "%3d", level);
-    lcdPrintAt(13, 1, lvlbuf);
-    prevState.autoCost = cost;
-    prevState.autoIncome = income;
-    prevState.autoLevel = level;
+  if (isDirty(DIRTY_AUTOCLICK)) {
+    char buf[LCD_WIDTH + 1];
+    formatAutoClickRow(buf, sizeof(buf), 0);
+    lcdPrintAt(0, 0, buf);
+    formatAutoClickRow(buf, sizeof(buf), 1);
+    lcdPrintAt(0, 1, buf);
   }
 }
 
 void displayCursor() {
+  // A scrolling ticker has moved the DDRAM under the panel; a text screen has
+  // nothing to select anyway
+  if (tickerActive) {
+    prevCursorX = cursorX;
+    prevCursorY = cursorY;
+    return;
+  }
+
   // Always redraw previous cursor position when cursor moves
-  if (prevCursorX != cursorX || prevCursorY != cursorY) {
+  if (prevCursorX >= 0 && (prevCursorX != cursorX || prevCursorY != cursorY)) {
     redrawElementAt(prevCursorX, prevCursorY);
   }
   
@@ -200,132 +333,82 @@ void displayCursor() {
   prevCursorY = cursorY;
 }
 
-// Reset screen state
-void resetPrevScreenVars() {
-  memset(&prevState, -1, sizeof(prevState));
-}
-
 // Redraw the element at the given position depending on the current screen
 void redrawElementAt(int x, int y) {
   switch (currentScreen) {
     case MAIN:
-      if (y == 0) {
-        // Top row: cookies, gift, or farm buttons
-        if (giftActive && x == giftPos) {
-          lcdPrintAt(x, y, "#");
-        } else if (x >= 0 && x < getDigitCount(cookies)) {
-          // Redraw cookie digit
-          char buf[8];
-          snprintf(buf, sizeof(buf), "%ld", cookies);
-          int len = strlen(buf);
-          if (x < len) {
-            char c[2] = {buf[x], '\0'};
-            lcdPrintAt(x, y, c);
-          } else {
-            lcdPrintAt(x, y, " ");
-          }
-        } else if (x == getDigitCount(cookies)) {
-          lcdPrintAt(x, y, "S"); // Только S после печенек
-        } else if (x >= BUTTON_FARM_X_START && x <= BUTTON_FARM_X_END) {
-          lcdPrintAt(x, y, "J"); // Farm buttons on top row
-        } else {
-          lcdPrintAt(x, y, " ");
-        }
-      } else if (y == 1) {
-        // Bottom row: buttons
-        if (x >= BUTTON_SHOP_X_START && x <= BUTTON_SHOP_X_END) {
-          const char* shopText = "SHOP";
-          lcdPrintAt(x, y, shopText + (x - BUTTON_SHOP_X_START));
-        } else if (x == BUTTON_AUTOCLICK_X) {
-          lcdPrintAt(x, y, "a");
-        } else if (x == BUTTON_PRESTIGE_X) {
-          lcdPrintAt(x, y, "*"); // Звездочка для престижа
-        } else if (x >= BUTTON_FARM_X_START && x <= BUTTON_FARM_X_END) {
-          lcdPrintAt(x, y, "J"); // Farm buttons on bottom row
-        } else {
-          lcdPrintAt(x, y, " ");
-        }
+      if (game.giftActive && y == 0 && x == game.giftPos) {
+        lcdPrintAt(x, y, "#");
+      } else if (isFarmCell(x, y)) {
+        lcdPrintAt(x, y, "J");
+      } else if (y == 0 && x >= 0 && x < Panel::GIFT_X_START) {
+        // Cookie digits and the stats button
+        char buf[LCD_WIDTH + 1];
+        formatCookieField(buf, sizeof(buf));
+        lcdWriteAt(x, y, buf[x]);
+      } else if (y == BUTTON_MENU_Y && x >= BUTTON_SHOP_X_START && x <= BUTTON_SHOP_X_END) {
+        const char* shopText = "SHOP";
+        lcdPrintAt(x, y, shopText + (x - BUTTON_SHOP_X_START));
+      } else if (y == BUTTON_MENU_Y && x == BUTTON_AUTOCLICK_X) {
+        lcdPrintAt(x, y, "a");
+      } else if (y == BUTTON_MENU_Y && x == BUTTON_PRESTIGE_X) {
+        lcdPrintAt(x, y, "*"); // Звездочка для престижа
+      } else if (y == BUTTON_MENU_Y && x == BUTTON_GENERATOR_X) {
+        lcdPrintAt(x, y, "g");
+      } else {
+        lcdPrintAt(x, y, " ");
       }
       break;
     case SHOP:
-      if (y == 0 && x == 0) drawButton(0, 0, "^", false);
-      else if (y == 1 && x == 0) drawButton(0, 1, "<", false);
-      else if (y == 0 && x > 0 && x < 16) lcdPrintAt(x, 0, " ");
-      else if (y == 1 && x > 0 && x < 16) lcdPrintAt(x, 1, " ");
-      break;
     case AUTOCLICK_SHOP:
-      if (y == 0 && x == 0) drawButton(0, 0, "^", false);
-      else if (y == 1 && x == 0) drawButton(0, 1, "<", false);
-      else if (y == 0 && x > 0 && x < 16) lcdPrintAt(x, 0, " ");
-      else if (y == 1 && x > 0 && x < 16) lcdPrintAt(x, 1, " ");
-      break;
     case STATS:
-      if (y == 0) {
-        if (x == 0) lcdPrintAt(0, 0, "T");
-        else if (x == 1) lcdPrintAt(1, 0, ":");
-        else if (x >= 2 && x < 13) {
-          // Redraw total cookies digits
-          char buf[13];
-          snprintf(buf, sizeof(buf), "%11ld", totalCookies);
-          lcdPrintAt(x, 0, buf[x-2]);
+    case RATES:
+    case GENERATOR_SHOP:
+      if (Panel::inBounds(x, y)) {
+        char buf[LCD_WIDTH + 1];
+        if (currentScreen == SHOP) {
+          formatShopRow(buf, sizeof(buf), y);
+        } else if (currentScreen == AUTOCLICK_SHOP) {
+          formatAutoClickRow(buf, sizeof(buf), y);
+        } else if (currentScreen == RATES) {
+          formatRatesRow(buf, sizeof(buf), y);
+        } else if (currentScreen == GENERATOR_SHOP) {
+          formatGeneratorRow(buf, sizeof(buf), y);
+        } else {
+          formatStatsRow(buf, sizeof(buf), y);
         }
-        else if (x == 15) lcdPrintAt(15, 0, "S");
-        else lcdPrintAt(x, 0, " ");
-      } else if (y == 1) {
-        if (x == 0) lcdPrintAt(0, 1, "<");
-        else if (x == 1) lcdPrintAt(1, 1, "L");
-        else if (x == 2) lcdPrintAt(2, 1, ":");
-        else if (x == 3) lcdPrintAt(3, 1, getLevel(cookiesPerClick));
-        else if (x == 5) lcdPrintAt(5, 1, "U");
-        else if (x == 6) lcdPrintAt(6, 1, ":");
-        else if (x == 7) lcdPrintAt(7, 1, totalUpgrades);
-        else if (x == 9) lcdPrintAt(9, 1, "C");
-        else if (x == 10) lcdPrintAt(10, 1, ":");
-        else if (x == 11) lcdPrintAt(11, 1, totalClicks);
-        else if (x == 15) lcdPrintAt(15, 1, "R");
-        else lcdPrintAt(x, 1, " ");
+        lcdWriteAt(x, y, buf[x]);
       }
       break;
     case PRESTIGE_CONFIRM:
       if (y == 0) {
         const char* sureText = "ARE YOU SURE?";
-        if (x < strlen(sureText)) {
+        if (x < (int)strlen(sureText)) {
           char c[2] = {sureText[x], '\0'};
           lcdPrintAt(x, 0, c);
         } else {
           lcdPrintAt(x, 0, " ");
         }
       } else if (y == 1) {
+        // The buttons reach a cell past their labels
+        const char* label = "";
+        int offset = 0;
         if (x >= BUTTON_PRESTIGE_NO_X_START && x <= BUTTON_PRESTIGE_NO_X_END) {
-          const char* noText = "NO";
-          lcdPrintAt(x, 1, noText + (x - BUTTON_PRESTIGE_NO_X_START));
+          label = "NO";
+          offset = x - BUTTON_PRESTIGE_NO_X_START;
         } else if (x >= BUTTON_PRESTIGE_YES_X_START && x <= BUTTON_PRESTIGE_YES_X_END) {
-          const char* yesText = "YES";
-          lcdPrintAt(x, 1, yesText + (x - BUTTON_PRESTIGE_YES_X_START));
-        } else {
-          lcdPrintAt(x, 1, " ");
+          label = "YES";
+          offset = x - BUTTON_PRESTIGE_YES_X_START;
         }
+        lcdWriteAt(x, 1, offset < (int)strlen(label) ? label[offset] : ' ');
+      } else if (Panel::inBounds(x, y)) {
+        lcdPrintAt(x, y, " ");
       }
       break;
     case MESSAGE_SCREEN:
-      if (y == 0) {
-        if (x >= 0 && x < 16) {
-          if (x < strlen(messageLine1) && messageLine1[x] != '\0') {
-            char c[2] = {messageLine1[x], '\0'};
-            lcdPrintAt(x, 0, c);
-          } else {
-            lcdPrintAt(x, 0, " ");
-          }
-        }
-      } else if (y == 1) {
-        if (x >= 0 && x < 16) {
-          if (x < strlen(messageLine2) && messageLine2[x] != '\0') {
-            char c[2] = {messageLine2[x], '\0'};
-            lcdPrintAt(x, 1, c);
-          } else {
-            lcdPrintAt(x, 1, " ");
-          }
-        }
+      if (Panel::inBounds(x, y)) {
+        const char* row = textScreenRow(messageLine1, messageLine2, y);
+        lcdWriteAt(x, y, x < (int)strlen(row) ? row[x] : ' ');
       }
       break;
     default:
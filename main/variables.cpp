@@ -50,85 +50,117 @@ uint8_t starIcon[8] = {
   B00000
 };
 
-// LCD object
-LiquidCrystal lcd(PIN_RS, PIN_EN, PIN_DB4, PIN_DB5, PIN_DB6, PIN_DB7);
+#if VIRTUAL_TIME
+// Simulated clock, starts shortly before the 49.7-day millis() wraparound
+unsigned long virtualMillis = VIRTUAL_TIME_START;
+#endif
 
-// Game Variables
-long cookies = 0;
-int cookiesPerClick = 1;
+// LCD object
+LcdDevice lcd;
+
+// Game State
+GameModel game = {
+  0,     // cookies
+  1,     // cookiesPerClick
+  0,     // totalCookies
+  0,     // totalClicks
+  0,     // totalUpgrades
+  0,     // autoClickLevel
+  1,     // prestigeClickLevel
+  0,     // prestigeAutoClickLevel
+  {0},   // generatorLevels
+  {0},   // achievements
+  0,     // passiveIncome
+  false, // giftActive
+  0,     // giftType
+  Panel::GIFT_X_START, // giftPos
+  false, // bonus573Active
+  false, // congratsActive
+  DIRTY_SCREEN,
+  0
+};
 
 // Cursor Variables
-int cursorX = 15;
-int cursorY = 1;
-int prevCursorX = 15;
-int prevCursorY = 1;
+int cursorX = Panel::LAST_X;
+int cursorY = Panel::MENU_ROW;
+int prevCursorX = Panel::LAST_X;
+int prevCursorY = Panel::MENU_ROW;
 
 // Screen State Management
 GameState currentScreen = MAIN;
 GameState lastScreen = MAIN;
 
-// Non-blocking Timers
-unsigned long lastButtonPressTime = 0;
-unsigned long lastJoystickMoveTime = 0;
-
 // Cursor Blinking
 unsigned long lastBlinkTime = 0;
 bool cursorVisible = true;
 
 // Message Screen Variables
-char messageLine1[17] = "";
-char messageLine2[17] = "";
+char messageLine1[MESSAGE_MAX + 1] = "";
+char messageLine2[MESSAGE_MAX + 1] = "";
 GameState screenAfterMessage = MAIN;
 unsigned long messageDisplayStart = 0;
 unsigned long messageTimeout = 0; // 0 = no timeout
 
-// Prestige Bonuses
-int prestigeClickLevel = 1;
-int prestigeAutoClickLevel = 0;
+// Boot timing
+unsigned long bootTimeUs = 0;
+SaveStatus bootSaveStatus = SAVE_BLANK;
 
 // Milestone Bonus Variable
 long nextMilestone = 100;
 
-// Statistics
-long totalCookies = 0;
-long totalClicks = 0;
-long totalUpgrades = 0;
-
 // Auto-save
-long lastSavedCookies = 0;
-
-// --- Gifts ---
-const char* GIFT_TEXTS[GIFT_COUNT] = {
-  "+100 cookies",
-  "+500 cookies",
-  "+1000 cookies",
-  "+5000 cookies",
-  "+10000 cookies",
-  "+15000 cookies",
-  "+50 click power",
-  "+1 level",
-  "60s: +573/click"
+unsigned long lastSaveTime = 0;
+unsigned long saveCount = 0;
+
+// --- Generators ---
+const GeneratorDef GENERATORS[GENERATOR_COUNT] PROGMEM = {
+  // name      base cost  growth  yield
+  {"Grandma",      100,   115,      1},
+  {"Farm",        1100,   115,      8},
+  {"Mine",       12000,   116,     47},
+  {"Factory",   130000,   117,    260},
+  {"Bank",     1400000,   118,   1400}
+};
+uint8_t generatorShopIndex = 0;
+
+// --- Achievements ---
+const AchievementDef ACHIEVEMENTS[ACHIEVEMENT_COUNT] PROGMEM = {
+  // ACH_COOKIES
+  {1000L, "1K cookies"},
+  {100000L, "100K cookies"},
+  {10000000L, "10M cookies"},
+  {1000000000L, "1B cookies"},
+  // ACH_CLICKS
+  {100L, "100 clicks"},
+  {1000L, "1000 clicks"},
+  {10000L, "10K clicks"},
+  {100000L, "100K clicks"},
+  // ACH_UPGRADES
+  {5L, "5 upgrades"},
+  {25L, "25 upgrades"},
+  {100L, "100 upgrades"},
+  // ACH_AUTOCLICK
+  {1L, "Autoclicker"},
+  {10L, "Auto level 10"},
+  {25L, "Auto level 25"},
+  // ACH_PRESTIGE (prestige click level)
+  {8L, "Prestige"},
+  {10L, "Prestige max"}
 };
+const uint8_t ACHIEVEMENT_GROUP_START[ACH_COUNTER_COUNT + 1] PROGMEM = {0, 4, 8, 11, 14, 16};
 
 // Gift Variables
-bool giftActive = false;
-int giftType = 0;
-int giftPos = 8;
 unsigned long lastGiftTime = 0;
 
 // Congratulations Screen
-bool congratsActive = false;
 unsigned long congratsStart = 0;
 
 // Temporary Bonus
-bool bonus573Active = false;
 unsigned long bonus573Start = 0;
+int giftClickBonus = 0;
 
 // --- Autoclicker Variables ---
-int autoClickLevel = 0; // Level 0 means not purchased
 unsigned long lastAutoClickTime = 0;
 
-bool needRedraw = true;
-
-// Screen state structure
-ScreenState prevState = {-1, -1, false, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}; 
+// Synthetic joystick input
+uint8_t injectedButtons = 0;
@@ -0,0 +1,89 @@
+#ifndef VIRTUAL_TIME_H
+#define VIRTUAL_TIME_H
+
+#include "config.h"
+#include "game_state.h"
+#include "save_system.h"
+#include "history_log.h"
+
+#if VIRTUAL_TIME
+
+// --- VIRTUAL-TIME SIMULATOR ---
+// nowMs() reads virtualMillis, which advanceVirtualClock() moves straight to the
+// earliest pending deadline instead of waiting for it. A simulated player opens
+// every gift, frames stay paced in real time (frame_pacing.h), and one summary
+// line per virtual hour goes to Serial. Saves and the history log stay in RAM
+// (save_system.h, history_log.h): the real save is loaded at boot, but the
+// EEPROM is never written. Build with -DSERIAL_CONSOLE=1 to set up a scenario
+// from the console.
+
+unsigned long simGiftsOpened = 0;
+unsigned long simWraps = 0;
+unsigned long simReportStart = VIRTUAL_TIME_START;
+unsigned long simHours = 0;
+long simCookiesAtReport = 0;
+
+// Shrink `wait` to the time left until a timer written as
+// `now - start > interval` fires
+void considerDeadline(unsigned long& wait, bool pending, unsigned long start, unsigned long interval) {
+  if (!pending) return;
+  unsigned long elapsed = virtualMillis - start;
+  unsigned long left = elapsed > interval ? 0 : interval + 1 - elapsed;
+  if (left < wait) wait = left;
+}
+
+void reportSimulation() {
+  Serial.print(F("sim h="));
+  Serial.print(simHours);
+  Serial.print(F(" wraps="));
+  Serial.print(simWraps);
+  Serial.print(F(" cookies="));
+  Serial.print(game.cookies);
+  Serial.print(F(" per_h="));
+  Serial.print(game.cookies - simCookiesAtReport);
+  Serial.print(F(" gifts="));
+  Serial.print(simGiftsOpened);
+  Serial.print(F(" saves="));
+  Serial.print(saveCount);
+  Serial.print(F(" history_writes="));
+  Serial.println(historyWrites);
+  simCookiesAtReport = game.cookies;
+}
+
+// Called at the top of loop(): play the simulated player, then jump the clock
+void advanceVirtualClock() {
+  if (game.giftActive && !game.congratsActive && currentScreen == MAIN) {
+    activateGift();
+    simGiftsOpened++;
+  }
+
+  unsigned long wait = VIRTUAL_TIME_REPORT_INTERVAL;
+  considerDeadline(wait, !game.giftActive && !game.congratsActive && currentScreen == MAIN,
+                   lastGiftTime, GIFT_INTERVAL);
+  considerDeadline(wait, game.bonus573Active, bonus573Start, BONUS573_TIME);
+  considerDeadline(wait, game.congratsActive, congratsStart, CONGRATS_TIME);
+  considerDeadline(wait, currentScreen == MAIN && game.passiveIncome > 0,
+                   lastAutoClickTime, AUTOCLICK_INTERVAL);
+  considerDeadline(wait, true, lastBlinkTime, BLINK_INTERVAL);
+  considerDeadline(wait, currentScreen == MESSAGE_SCREEN && messageTimeout > 0,
+                   messageDisplayStart, messageTimeout);
+  considerDeadline(wait, game.unsaved != 0, lastSaveTime, AUTOSAVE_INTERVAL - 1);
+  considerDeadline(wait, true, historyHourStart, HISTORY_INTERVAL - 1);
+  considerDeadline(wait, true, simReportStart, VIRTUAL_TIME_REPORT_INTERVAL - 1);
+  // Held (injected) buttons need debounce and joystick timing at 1 ms resolution
+  if (injectedButtons != 0 && wait > 1) wait = 1;
+
+  unsigned long before = virtualMillis;
+  virtualMillis += wait;
+  if (virtualMillis < before) simWraps++;
+
+  if (virtualMillis - simReportStart >= VIRTUAL_TIME_REPORT_INTERVAL) {
+    simReportStart = virtualMillis;
+    simHours++;
+    reportSimulation();
+  }
+}
+
+#endif // VIRTUAL_TIME
+
+#endif // VIRTUAL_TIME_H
@@ -0,0 +1,155 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "config.h"
+#include "ui_screens.h"
+
+// Where setup() and loop() are, for the breadcrumbs
+enum LoopStage : uint8_t {
+  STAGE_BOOT,    // LCD and pins
+  STAGE_LOAD,    // save, achievements, history, milestone
+  STAGE_CONSOLE, // serial console, budget script, virtual clock
+  STAGE_TIMERS,  // milestones, messages, gifts, income, rates
+  STAGE_INPUT,
+  STAGE_SAVE,
+  STAGE_HISTORY,
+  STAGE_RENDER,
+  STAGE_IDLE,    // between two passes
+  STAGE_COUNT
+};
+
+#if WATCHDOG
+
+#include <avr/io.h>
+#include <avr/wdt.h>
+
+// --- WATCHDOG AND BREADCRUMBS ---
+// The watchdog is fed once per loop(), so any pass (or setup()) longer than
+// WATCHDOG_TIMEOUT resets the board. Breadcrumbs live in .noinit RAM, which a
+// reset leaves alone: the current stage, the worst loop time over the last
+// 10-20 s and the uptime. beginWatchdog() copies them before this run starts
+// writing its own. Why we were reset is read in .init3, before the global
+// constructors: the LCD constructor alone takes ~50 ms, longer than the 16 ms
+// a watchdog left running after its reset allows.
+
+const uint16_t BREADCRUMB_MAGIC = 0xB12D;
+const unsigned long WORST_LOOP_WINDOW_MS = 10000;
+
+const char STAGE_NAMES[STAGE_COUNT][8] PROGMEM = {
+  "boot", "load", "console", "timers", "input", "save", "history", "render", "idle"
+};
+
+struct Breadcrumbs {
+  uint16_t magic;
+  LoopStage stage;
+  uint16_t worstLoopMs;
+  unsigned long uptimeS;
+};
+
+Breadcrumbs breadcrumbs __attribute__((section(".noinit")));
+Breadcrumbs lastRun;       // the previous run's breadcrumbs, if lastRunValid
+bool lastRunValid = false;
+// MCUSR at reset. Set in .init3, which runs before .bss is cleared, so it must
+// not be cleared itself.
+uint8_t resetFlags __attribute__((section(".noinit")));
+
+// Runs from the startup code, before any constructor. Optiboot clears MCUSR and
+// hands the flags over in r2. A watchdog reset leaves the watchdog running at its
+// shortest timeout, so it is stopped here until beginWatchdog().
+void captureResetFlags() __attribute__((naked, used, section(".init3")));
+void captureResetFlags() {
+  uint8_t flags = MCUSR;
+  if (flags == 0) {
+    __asm__ __volatile__("mov %0, r2" : "=r"(flags));
+  }
+  resetFlags = flags;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+inline void breadcrumb(LoopStage stage) {
+  breadcrumbs.stage = stage;
+}
+
+// First thing in setup(): keep the old breadcrumbs, then arm the watchdog
+void beginWatchdog() {
+  // After power-on the .noinit RAM is random
+  lastRunValid = breadcrumbs.magic == BREADCRUMB_MAGIC && !(resetFlags & _BV(PORF)) &&
+                 breadcrumbs.stage < STAGE_COUNT;
+  lastRun = breadcrumbs;
+  breadcrumbs = {BREADCRUMB_MAGIC, STAGE_BOOT, 0, 0};
+
+  wdt_enable(WATCHDOG_TIMEOUT);
+}
+
+// Top of loop(): feed the watchdog and time the pass that just ended
+void watchdogLoopStart() {
+  static unsigned long lastStart = 0;
+  static unsigned long windowStart = 0;
+  static uint16_t windowWorst = 0;
+  static uint16_t previousWorst = 0;
+
+  wdt_reset();
+  unsigned long now = millis();
+  unsigned long loopMs = lastStart == 0 ? 0 : now - lastStart; // the first pass follows setup()
+  lastStart = now;
+  if (loopMs > windowWorst) windowWorst = loopMs > 0xFFFF ? 0xFFFF : loopMs;
+  if (now - windowStart >= WORST_LOOP_WINDOW_MS) {
+    previousWorst = windowWorst;
+    windowWorst = 0;
+    windowStart = now;
+  }
+  breadcrumbs.worstLoopMs = windowWorst > previousWorst ? windowWorst : previousWorst;
+  breadcrumbs.uptimeS = now / 1000;
+}
+
+// How long the previous run was up, in seconds; 0 when its breadcrumbs are gone
+unsigned long lastRunUptimeS() {
+  return lastRunValid ? lastRun.uptimeS : 0;
+}
+
+bool watchdogTripped() {
+  return resetFlags & _BV(WDRF);
+}
+
+void readStageName(LoopStage stage, char* buf) {
+  strcpy_P(buf, STAGE_NAMES[stage < STAGE_COUNT ? stage : STAGE_IDLE]);
+}
+
+// After the boot frame: tell whoever is watching why we were reset
+void reportWatchdog() {
+  char stage[sizeof(STAGE_NAMES[0])];
+  readStageName(lastRun.stage, stage);
+
+#if LCD_BUDGET_CHECK || SERIAL_CONSOLE || VIRTUAL_TIME
+  Serial.print(F("reset_flags="));
+  Serial.print(resetFlags);
+  if (lastRunValid) {
+    Serial.print(F(" last_stage="));
+    Serial.print(stage);
+    Serial.print(F(" last_worst_loop_ms="));
+    Serial.print(lastRun.worstLoopMs);
+    Serial.print(F(" last_uptime_s="));
+    Serial.print(lastRun.uptimeS);
+  }
+  Serial.println(watchdogTripped() ? F(" WATCHDOG") : F(""));
+#endif
+
+  if (watchdogTripped() && lastRunValid) {
+    char line[MESSAGE_MAX + 1];
+    snprintf(line, sizeof(line), "in %s, worst loop %ums", stage, lastRun.worstLoopMs);
+    showMessage("WATCHDOG RESET", line, MAIN, 5000);
+  }
+}
+
+#else
+
+inline void breadcrumb(LoopStage) {}
+
+inline unsigned long lastRunUptimeS() {
+  return 0;
+}
+
+#endif // WATCHDOG
+
+#endif // WATCHDOG_H